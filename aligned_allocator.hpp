@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include "vector.hpp"
+
+// Allocator whose blocks start on an *Align* byte boundary, i.e. a cache line (64)
+// or a page (4096). vector also pads the capacity of such blocks to whole
+// *Align* byte chunks, so SIMD loops can run over the tail without a scalar remainder
+template <class T, size_t Align>
+class aligned_allocator {
+        static_assert(Align && (Align & (Align - 1)) == 0, "aligned_allocator: alignment must be a power of two");
+        static_assert(Align >= alignof(T), "aligned_allocator: alignment is weaker than the type's own");
+    public:
+        typedef T value_type;
+        typedef size_t size_type;
+        static constexpr size_type alignment = Align;
+
+        template <class U>
+        struct rebind { typedef aligned_allocator<U, Align> other; };
+
+        aligned_allocator() noexcept = default;
+        template <class U>
+        aligned_allocator(const aligned_allocator<U, Align>&) noexcept {}
+
+        T* allocate( size_type n );
+        void deallocate( T* p, size_type n ) noexcept;
+
+        template <class U>
+        bool operator==(const aligned_allocator<U, Align>&) const noexcept { return true; }
+        template <class U>
+        bool operator!=(const aligned_allocator<U, Align>&) const noexcept { return false; }
+};
+
+// Allocate space for *n* objects, aligned to *Align* bytes
+template <class T, size_t Align>
+T* aligned_allocator<T, Align>::allocate( size_type n ) {
+    if (n > size_type(-1) / sizeof(T))
+        throw std::bad_array_new_length{};
+    return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{ Align }));
+}
+
+// Release space of *n* objects, allocated by allocate()
+template <class T, size_t Align>
+void aligned_allocator<T, Align>::deallocate( T* p, size_type ) noexcept {
+    ::operator delete(static_cast<void*>(p), std::align_val_t{ Align });
+}
+
+// Vector whose data() is aligned to *Align* bytes, i.e.
+//   aligned_vector<float, 32> v;   // AVX2 loads of v.data() never straddle a vector
+template <class T, size_t Align, class Growth = grow_twice>
+using aligned_vector = vector<T, aligned_allocator<T, Align>, Growth>;
@@ -0,0 +1,553 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include "vector.hpp"
+
+// Lazy element-wise arithmetic on vectors of numbers. With this header
+//   r = b * c + d;
+// builds a small tree of nodes instead of temporary vectors, and assigning
+// the tree to r (or building r from it) evaluates it in one pass straight
+// into r's block. Trees of float and double are evaluated by SSE2 / AVX2 /
+// AVX-512 kernels, others by a loop the compiler may vectorize itself.
+// Nodes point into their vectors, so they have to be evaluated before any
+// of those change size or go away - don't keep them in auto variables.
+//
+// Operands are vectors, nodes and numbers (broadcast to every element;
+// floating point numbers must not narrow, i.e. 0.5f, not 0.5, with floats):
+//   + - * /, unary -, sqrt() and abs() of numbers,
+//   < <= > >= == != of numbers into masks, && || ! of masks,
+//   where(mask, a, b) - a's element where the mask is set, else b's.
+// Two plain vectors keep comparing as wholes: for element-wise masks one of
+// them is wrapped by expr::lazy(), i.e. expr::lazy(a) < b. Masks are evaluated
+// into vectors of bool, every other node into vectors of its value_type
+
+// The nodes call AVX operations from generic code, which GCC notes would pass
+// vectors differently; they are all inlined into the kernels, so it doesn't apply
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
+#endif
+
+namespace expr {
+
+constexpr size_t any_size = size_t(-1);    // size() of a number, which matches any vector
+
+// Size of two operands, which must be equal unless one of them is a number
+inline size_t common_size( size_t a, size_t b ) {
+    if (a != b && a != any_size && b != any_size)
+        throw std::invalid_argument{ "vector::expression" };
+    return std::min(a, b);
+}
+
+// Write the elements of *e* to [out, out + n)
+template <class E>
+void evaluate( const E& e, typename E::value_type* out, size_t n );
+
+// Base of the nodes. *Derived* has value_type, size() and operator[], and
+// packet<Ops>(i, out), which sets out to the SIMD vector of elements from i,
+// or if it's a mask, mask<Ops>(i, out) and operand_type, the type of the
+// compared elements. SIMD vectors are passed by reference, so that no generic
+// function takes or returns them by value, which GCC's ABI notes would flag
+template <class Derived>
+struct node : vector_expression {
+    template <class T>
+    void evaluate( T* out ) const {
+        expr::evaluate(static_cast<const Derived&>(*this), out, static_cast<const Derived&>(*this).size());
+    }
+};
+
+// Elements of a vector
+template <class T>
+struct leaf : node<leaf<T>> {
+    typedef T value_type;
+    const T* first;
+    size_t count;
+    leaf( const T* first, size_t count ) : first(first), count(count) {}
+    size_t size() const { return count; }
+    T operator[]( size_t i ) const { return first[i]; }
+    template <class Ops>
+    void packet( size_t i, typename Ops::type& out ) const { out = Ops::load(first + i); }
+};
+
+// A number standing for every element
+template <class T>
+struct scalar : node<scalar<T>> {
+    typedef T value_type;
+    T value;
+    explicit scalar( T value ) : value(value) {}
+    size_t size() const { return any_size; }
+    T operator[]( size_t ) const { return value; }
+    template <class Ops>
+    void packet( size_t, typename Ops::type& out ) const { out = Ops::splat(value); }
+};
+
+// Operations of the nodes below: apply(...) returns the result for elements,
+// apply(Ops, ...) stores it to its first argument for SIMD vectors
+
+struct plus {
+    template <class T> static T apply( T a, T b ) { return T(a + b); }
+    template <class Ops, class V> static void apply( Ops, V& a, const V& b ) { a = Ops::add(a, b); }
+};
+
+struct minus {
+    template <class T> static T apply( T a, T b ) { return T(a - b); }
+    template <class Ops, class V> static void apply( Ops, V& a, const V& b ) { a = Ops::sub(a, b); }
+};
+
+struct multiplies {
+    template <class T> static T apply( T a, T b ) { return T(a * b); }
+    template <class Ops, class V> static void apply( Ops, V& a, const V& b ) { a = Ops::mul(a, b); }
+};
+
+struct divides {
+    template <class T> static T apply( T a, T b ) { return T(a / b); }
+    template <class Ops, class V> static void apply( Ops, V& a, const V& b ) { a = Ops::div(a, b); }
+};
+
+struct negate {
+    template <class T> static T apply( T a ) { return T(-a); }
+    template <class Ops, class V> static void apply( Ops, V& a ) { a = Ops::neg(a); }
+};
+
+struct absolute {
+    template <class T> static T apply( T a ) {
+        if constexpr (std::is_unsigned<T>::value)
+            return a;
+        else return T(std::abs(a));
+    }
+    template <class Ops, class V> static void apply( Ops, V& a ) { a = Ops::abs(a); }
+};
+
+struct square_root {
+    template <class T> static T apply( T a ) { return T(std::sqrt(a)); }
+    template <class Ops, class V> static void apply( Ops, V& a ) { a = Ops::sqrt(a); }
+};
+
+struct less {
+    template <class T> static bool apply( T a, T b ) { return a < b; }
+    template <class Ops, class V> static void apply( Ops, typename Ops::mask& m, const V& a, const V& b ) { m = Ops::less(a, b); }
+};
+
+struct less_equal {
+    template <class T> static bool apply( T a, T b ) { return a <= b; }
+    template <class Ops, class V> static void apply( Ops, typename Ops::mask& m, const V& a, const V& b ) { m = Ops::less_equal(a, b); }
+};
+
+struct greater {
+    template <class T> static bool apply( T a, T b ) { return a > b; }
+    template <class Ops, class V> static void apply( Ops, typename Ops::mask& m, const V& a, const V& b ) { m = Ops::less(b, a); }
+};
+
+struct greater_equal {
+    template <class T> static bool apply( T a, T b ) { return a >= b; }
+    template <class Ops, class V> static void apply( Ops, typename Ops::mask& m, const V& a, const V& b ) { m = Ops::less_equal(b, a); }
+};
+
+struct equal_to {
+    template <class T> static bool apply( T a, T b ) { return a == b; }
+    template <class Ops, class V> static void apply( Ops, typename Ops::mask& m, const V& a, const V& b ) { m = Ops::equal(a, b); }
+};
+
+struct not_equal_to {
+    template <class T> static bool apply( T a, T b ) { return a != b; }
+    template <class Ops, class V> static void apply( Ops, typename Ops::mask& m, const V& a, const V& b ) { m = Ops::not_equal(a, b); }
+};
+
+struct logical_and {
+    static bool apply( bool a, bool b ) { return a && b; }
+    template <class Ops, class M> static void apply( Ops, M& a, const M& b ) { a = Ops::both(a, b); }
+};
+
+struct logical_or {
+    static bool apply( bool a, bool b ) { return a || b; }
+    template <class Ops, class M> static void apply( Ops, M& a, const M& b ) { a = Ops::either(a, b); }
+};
+
+// Op of the elements of a
+template <class Op, class A>
+struct unary : node<unary<Op, A>> {
+    typedef typename A::value_type value_type;
+    A a;
+    explicit unary( const A& a ) : a(a) {}
+    size_t size() const { return a.size(); }
+    value_type operator[]( size_t i ) const { return Op::apply(a[i]); }
+    template <class Ops>
+    void packet( size_t i, typename Ops::type& out ) const {
+        a.template packet<Ops>(i, out);
+        Op::apply(Ops(), out);
+    }
+};
+
+// Op of the elements of a and b
+template <class Op, class A, class B>
+struct binary : node<binary<Op, A, B>> {
+    typedef typename A::value_type value_type;
+    A a;
+    B b;
+    binary( const A& a, const B& b ) : a(a), b(b) { common_size(a.size(), b.size()); }
+    size_t size() const { return std::min(a.size(), b.size()); }
+    value_type operator[]( size_t i ) const { return Op::apply(a[i], b[i]); }
+    template <class Ops>
+    void packet( size_t i, typename Ops::type& out ) const {
+        typename Ops::type other;
+        a.template packet<Ops>(i, out);
+        b.template packet<Ops>(i, other);
+        Op::apply(Ops(), out, other);
+    }
+};
+
+// Mask of Op applied to the elements of a and b
+template <class Op, class A, class B>
+struct compare : node<compare<Op, A, B>> {
+    typedef bool value_type;
+    typedef typename A::value_type operand_type;
+    A a;
+    B b;
+    compare( const A& a, const B& b ) : a(a), b(b) { common_size(a.size(), b.size()); }
+    size_t size() const { return std::min(a.size(), b.size()); }
+    bool operator[]( size_t i ) const { return Op::apply(a[i], b[i]); }
+    template <class Ops>
+    void mask( size_t i, typename Ops::mask& out ) const {
+        typename Ops::type x, y;
+        a.template packet<Ops>(i, x);
+        b.template packet<Ops>(i, y);
+        Op::apply(Ops(), out, x, y);
+    }
+};
+
+// Mask of Op applied to masks a and b
+template <class Op, class A, class B>
+struct logical : node<logical<Op, A, B>> {
+    typedef bool value_type;
+    typedef typename A::operand_type operand_type;
+    A a;
+    B b;
+    logical( const A& a, const B& b ) : a(a), b(b) { common_size(a.size(), b.size()); }
+    size_t size() const { return std::min(a.size(), b.size()); }
+    bool operator[]( size_t i ) const { return Op::apply(a[i], b[i]); }
+    template <class Ops>
+    void mask( size_t i, typename Ops::mask& out ) const {
+        typename Ops::mask other;
+        a.template mask<Ops>(i, out);
+        b.template mask<Ops>(i, other);
+        Op::apply(Ops(), out, other);
+    }
+};
+
+// Mask a inverted
+template <class A>
+struct inverse : node<inverse<A>> {
+    typedef bool value_type;
+    typedef typename A::operand_type operand_type;
+    A a;
+    explicit inverse( const A& a ) : a(a) {}
+    size_t size() const { return a.size(); }
+    bool operator[]( size_t i ) const { return !a[i]; }
+    template <class Ops>
+    void mask( size_t i, typename Ops::mask& out ) const {
+        a.template mask<Ops>(i, out);
+        out = Ops::invert(out);
+    }
+};
+
+// a's element where mask m is set, else b's
+template <class M, class A, class B>
+struct select : node<select<M, A, B>> {
+    typedef typename A::value_type value_type;
+    static_assert(std::is_same<typename M::operand_type, value_type>::value,
+                  "where: the mask compares elements of another type");
+    M m;
+    A a;
+    B b;
+    select( const M& m, const A& a, const B& b ) : m(m), a(a), b(b) { common_size(common_size(m.size(), a.size()), b.size()); }
+    size_t size() const { return std::min(m.size(), std::min(a.size(), b.size())); }
+    value_type operator[]( size_t i ) const { return m[i] ? a[i] : b[i]; }
+    template <class Ops>
+    void packet( size_t i, typename Ops::type& out ) const {
+        typename Ops::mask set;
+        typename Ops::type other;
+        m.template mask<Ops>(i, set);
+        a.template packet<Ops>(i, out);
+        b.template packet<Ops>(i, other);
+        out = Ops::select(set, out, other);
+    }
+};
+
+// Kernels. Each works on a copy of the tree, whose pointers the stores
+// to *out* can't change, so the compiler keeps them in registers
+
+template <class E>
+void evaluate_scalar( const E& e, typename E::value_type* out, size_t n ) {
+    E tree = e;
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)    // Blocks of known length, which compilers vectorize at -O2
+        for (size_t k = 0; k < 16; ++k)
+            out[i + k] = tree[i + k];
+    for (; i < n; ++i)
+        out[i] = tree[i];
+}
+
+#if defined(SIMD_SSE2)
+template <class E>
+SIMD_FLATTEN void evaluate_sse2( const E& e, typename E::value_type* out, size_t n ) {
+    typedef typename E::value_type T;
+    typedef simd::sse2_ops<T> ops;
+    constexpr size_t lanes = 16 / sizeof(T);
+    E tree = e;
+    size_t i = 0;
+    for (; i + lanes <= n; i += lanes) {
+        typename ops::type v;
+        tree.template packet<ops>(i, v);
+        ops::store(out + i, v);
+    }
+    for (; i < n; ++i)
+        out[i] = tree[i];
+}
+#endif
+
+// The AVX kernels work only if every node is inlined into them: without
+// optimization GCC leaves the calls, and generic code can't pass AVX vectors
+// to AVX operations, so unoptimized builds stop at SSE2
+#if !defined(SIMD_DISPATCH) || defined(__OPTIMIZE__)
+#if defined(SIMD_AVX2)
+#define EXPR_AVX2 1
+#endif
+#if defined(SIMD_AVX512)
+#define EXPR_AVX512 1
+#endif
+#endif
+#if defined(EXPR_AVX2)
+#define EXPR_IF_AVX2(kernel) kernel
+#else
+#define EXPR_IF_AVX2(kernel) nullptr
+#endif
+#if defined(EXPR_AVX512)
+#define EXPR_IF_AVX512(kernel) kernel
+#else
+#define EXPR_IF_AVX512(kernel) nullptr
+#endif
+
+#if defined(EXPR_AVX2)
+template <class E>
+SIMD_AVX2 SIMD_FLATTEN void evaluate_avx2( const E& e, typename E::value_type* out, size_t n ) {
+    typedef typename E::value_type T;
+    typedef simd::avx2_ops<T> ops;
+    constexpr size_t lanes = 32 / sizeof(T);
+    E tree = e;
+    size_t i = 0;
+    for (; i + lanes <= n; i += lanes) {
+        typename ops::type v;
+        tree.template packet<ops>(i, v);
+        ops::store(out + i, v);
+    }
+    for (; i < n; ++i)
+        out[i] = tree[i];
+}
+#endif
+
+#if defined(EXPR_AVX512)
+template <class E>
+SIMD_AVX512 SIMD_FLATTEN void evaluate_avx512( const E& e, typename E::value_type* out, size_t n ) {
+    typedef typename E::value_type T;
+    typedef simd::avx512_ops<T> ops;
+    constexpr size_t lanes = 64 / sizeof(T);
+    E tree = e;
+    size_t i = 0;
+    for (; i + lanes <= n; i += lanes) {
+        typename ops::type v;
+        tree.template packet<ops>(i, v);
+        ops::store(out + i, v);
+    }
+    for (; i < n; ++i)
+        out[i] = tree[i];
+}
+#endif
+
+template <class E>
+void evaluate( const E& e, typename E::value_type* out, size_t n ) {
+    typedef typename E::value_type T;
+    if constexpr (std::is_same<T, float>::value || std::is_same<T, double>::value) {
+        static const simd::dispatch_table<void (*)(const E&, T*, size_t)> table(
+            evaluate_scalar<E>, SIMD_IF_SSE2(evaluate_sse2<E>), EXPR_IF_AVX2(evaluate_avx2<E>), EXPR_IF_AVX512(evaluate_avx512<E>));
+        table()(e, out, n);
+    } else evaluate_scalar(e, out, n);
+}
+
+// Building trees out of operands
+
+template <class X>
+struct is_vector : std::false_type {};
+
+template <class T, class Allocator, class Growth>
+struct is_vector<::vector<T, Allocator, Growth>> : std::is_arithmetic<T> {};
+
+template <class X>
+struct is_node : std::is_base_of<vector_expression, X> {};
+
+template <class X>
+struct is_mask : std::false_type {};
+
+template <class Op, class A, class B>
+struct is_mask<compare<Op, A, B>> : std::true_type {};
+
+template <class Op, class A, class B>
+struct is_mask<logical<Op, A, B>> : std::true_type {};
+
+template <class A>
+struct is_mask<inverse<A>> : std::true_type {};
+
+// Vectors and nodes, whose elements the operators go through
+template <class X>
+struct is_array : std::integral_constant<bool, is_vector<X>::value || is_node<X>::value> {};
+
+// Element type of operands *X* and *Y*, of which at least one is an array
+template <class X, class Y, class = void>
+struct element_type { typedef typename X::value_type type; };
+
+template <class X, class Y>
+struct element_type<X, Y, std::enable_if_t<!is_array<X>::value>> { typedef typename Y::value_type type; };
+
+// Tells whether number *X* may be broadcast to elements of type T. Integers
+// always may, as constants like 2 are ints, but a floating point number may
+// not lose its fraction or range: 0.5 doesn't go with ints, a double not with floats
+template <class T, class X, class = void>
+struct is_scalar_for : std::false_type {};
+
+template <class T, class X>
+struct is_scalar_for<T, X, std::enable_if_t<std::is_arithmetic<X>::value>> : std::integral_constant<bool,
+    std::is_integral<X>::value || std::is_same<std::common_type_t<T, X>, T>::value> {};
+
+// Number *X* which may go with the elements of array *A*
+template <class X, class A, class = void>
+struct fits : std::false_type {};
+
+template <class X, class A>
+struct fits<X, A, std::enable_if_t<is_array<A>::value>> : is_scalar_for<typename A::value_type, X> {};
+
+// Tells whether an operator applies to X and Y: at least one array, the
+// other an array or a number which fits it. With *Lazy* plain vectors only
+// go with nodes or numbers
+template <class X, class Y, bool Lazy = false>
+struct are_operands : std::integral_constant<bool,
+    (is_array<X>::value && (is_array<Y>::value || fits<Y, X>::value) || fits<X, Y>::value)
+    && (!Lazy || !is_vector<X>::value || !is_vector<Y>::value)> {};
+
+// Node of an operand whose elements are T
+template <class T, class X>
+auto wrap( const X& x ) {
+    if constexpr (std::is_arithmetic<X>::value)
+        return scalar<T>(T(x));
+    else if constexpr (is_node<X>::value)
+        return x;
+    else return leaf<T>(x.begin(), x.size());
+}
+
+template <class T, class X>
+using wrapped = decltype(wrap<T>(std::declval<const X&>()));
+
+// Vector as a node, so that it's compared element by element
+template <class T, class Allocator, class Growth>
+leaf<T> lazy( const ::vector<T, Allocator, Growth>& v ) { return leaf<T>(v.begin(), v.size()); }
+
+template <class Op, class X>
+auto make_unary( const X& x ) {
+    typedef typename X::value_type T;
+    static_assert(!std::is_same<T, bool>::value, "vector::expression: arithmetic on bools");
+    return unary<Op, wrapped<T, X>>(wrap<T>(x));
+}
+
+template <class Op, class X, class Y>
+auto make_binary( const X& x, const Y& y ) {
+    typedef typename element_type<X, Y>::type T;
+    static_assert(!std::is_same<T, bool>::value, "vector::expression: arithmetic on bools");
+    return binary<Op, wrapped<T, X>, wrapped<T, Y>>(wrap<T>(x), wrap<T>(y));
+}
+
+template <class Op, class X, class Y>
+auto make_compare( const X& x, const Y& y ) {
+    typedef typename element_type<X, Y>::type T;
+    static_assert(!std::is_same<T, bool>::value, "vector::expression: comparing bools");
+    return compare<Op, wrapped<T, X>, wrapped<T, Y>>(wrap<T>(x), wrap<T>(y));
+}
+
+}
+
+// Operators, in the global namespace like vector; nodes find them through their base class
+
+template <class X, class Y, class = std::enable_if_t<expr::are_operands<X, Y>::value>>
+auto operator+( const X& x, const Y& y ) { return expr::make_binary<expr::plus>(x, y); }
+
+template <class X, class Y, class = std::enable_if_t<expr::are_operands<X, Y>::value>>
+auto operator-( const X& x, const Y& y ) { return expr::make_binary<expr::minus>(x, y); }
+
+template <class X, class Y, class = std::enable_if_t<expr::are_operands<X, Y>::value>>
+auto operator*( const X& x, const Y& y ) { return expr::make_binary<expr::multiplies>(x, y); }
+
+template <class X, class Y, class = std::enable_if_t<expr::are_operands<X, Y>::value>>
+auto operator/( const X& x, const Y& y ) { return expr::make_binary<expr::divides>(x, y); }
+
+template <class X, class = std::enable_if_t<expr::is_array<X>::value>>
+auto operator-( const X& x ) { return expr::make_unary<expr::negate>(x); }
+
+template <class X, class = std::enable_if_t<expr::is_array<X>::value>>
+auto sqrt( const X& x ) { return expr::make_unary<expr::square_root>(x); }
+
+template <class X, class = std::enable_if_t<expr::is_array<X>::value>>
+auto abs( const X& x ) { return expr::make_unary<expr::absolute>(x); }
+
+template <class X, class Y, class = std::enable_if_t<expr::are_operands<X, Y, true>::value>>
+auto operator<( const X& x, const Y& y ) { return expr::make_compare<expr::less>(x, y); }
+
+template <class X, class Y, class = std::enable_if_t<expr::are_operands<X, Y, true>::value>>
+auto operator<=( const X& x, const Y& y ) { return expr::make_compare<expr::less_equal>(x, y); }
+
+template <class X, class Y, class = std::enable_if_t<expr::are_operands<X, Y, true>::value>>
+auto operator>( const X& x, const Y& y ) { return expr::make_compare<expr::greater>(x, y); }
+
+template <class X, class Y, class = std::enable_if_t<expr::are_operands<X, Y, true>::value>>
+auto operator>=( const X& x, const Y& y ) { return expr::make_compare<expr::greater_equal>(x, y); }
+
+template <class X, class Y, class = std::enable_if_t<expr::are_operands<X, Y, true>::value>>
+auto operator==( const X& x, const Y& y ) { return expr::make_compare<expr::equal_to>(x, y); }
+
+template <class X, class Y, class = std::enable_if_t<expr::are_operands<X, Y, true>::value>>
+auto operator!=( const X& x, const Y& y ) { return expr::make_compare<expr::not_equal_to>(x, y); }
+
+template <class A, class B, class = std::enable_if_t<expr::is_mask<A>::value && expr::is_mask<B>::value>>
+auto operator&&( const A& a, const B& b ) { return expr::logical<expr::logical_and, A, B>(a, b); }
+
+template <class A, class B, class = std::enable_if_t<expr::is_mask<A>::value && expr::is_mask<B>::value>>
+auto operator||( const A& a, const B& b ) { return expr::logical<expr::logical_or, A, B>(a, b); }
+
+template <class A, class = std::enable_if_t<expr::is_mask<A>::value>>
+auto operator!( const A& a ) { return expr::inverse<A>(a); }
+
+// Element-wise choice: a's element where *mask* is set, else b's; a or b may be numbers
+template <class M, class X, class Y, class = std::enable_if_t<expr::is_mask<M>::value
+    && (expr::is_array<X>::value || expr::is_scalar_for<typename M::operand_type, X>::value)
+    && (expr::is_array<Y>::value || expr::is_scalar_for<typename M::operand_type, Y>::value)>>
+auto where( const M& mask, const X& a, const Y& b ) {
+    typedef typename M::operand_type T;
+    return expr::select<M, expr::wrapped<T, X>, expr::wrapped<T, Y>>(mask, expr::wrap<T>(a), expr::wrap<T>(b));
+}
+
+// Compound assignments, evaluated in one pass like v = v + x
+template <class T, class Allocator, class Growth, class X, class = std::enable_if_t<expr::are_operands<vector<T, Allocator, Growth>, X>::value>>
+vector<T, Allocator, Growth>& operator+=( vector<T, Allocator, Growth>& v, const X& x ) { return v = v + x; }
+
+template <class T, class Allocator, class Growth, class X, class = std::enable_if_t<expr::are_operands<vector<T, Allocator, Growth>, X>::value>>
+vector<T, Allocator, Growth>& operator-=( vector<T, Allocator, Growth>& v, const X& x ) { return v = v - x; }
+
+template <class T, class Allocator, class Growth, class X, class = std::enable_if_t<expr::are_operands<vector<T, Allocator, Growth>, X>::value>>
+vector<T, Allocator, Growth>& operator*=( vector<T, Allocator, Growth>& v, const X& x ) { return v = v * x; }
+
+template <class T, class Allocator, class Growth, class X, class = std::enable_if_t<expr::are_operands<vector<T, Allocator, Growth>, X>::value>>
+vector<T, Allocator, Growth>& operator/=( vector<T, Allocator, Growth>& v, const X& x ) { return v = v / x; }
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
@@ -0,0 +1,530 @@
+#pragma once
+
+#include "vector.hpp"
+
+// Vector which spreads its growth over later operations. When it is full it
+// takes a block twice as large but keeps the old one, and each push_back,
+// emplace_back or pop_back after that moves at most *moves_per_operation*
+// elements from the old block to the new one. No push_back relocates the
+// whole vector: the old block is empty after half as many pushes as it
+// holds, long before the new one fills up. Elements being migrated live in
+// either block, so element access checks which one and iterators are
+// indices. reserve(), shrink_to_fit(), insert() and erase() finish the
+// migration first. Iterators are invalidated like those of vector
+template <class T, class Allocator = std::allocator<T>>
+class incremental_vector {
+        template <class Owner, class Value>
+        class basic_iterator;   // element of a vector by index
+    public:
+        // Member types
+        typedef T value_type;
+        typedef Allocator allocator_type;
+        typedef std::allocator_traits<Allocator> alloc_traits;
+        typedef size_t size_type;
+        typedef value_type& reference;
+        typedef const value_type& const_reference;
+        typedef basic_iterator<incremental_vector, T> iterator;
+        typedef basic_iterator<const incremental_vector, const T> const_iterator;
+        typedef std::reverse_iterator<iterator> reverse_iterator;
+        typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+        static constexpr size_type moves_per_operation = 2;
+
+        // Member functions
+        incremental_vector() noexcept(noexcept(Allocator())) : alloc() { create(); }
+        explicit incremental_vector(const Allocator& a) noexcept : alloc(a) { create(); }
+        explicit incremental_vector(size_type n, const T& val = T{}, const Allocator& a = Allocator())
+            : alloc(a) { build([&] { resize(n, val); }); }
+        incremental_vector(std::initializer_list<T> array, const Allocator& a = Allocator()) // Create from array
+            : alloc(a) { build([&] { append(array.begin(), array.end()); }); }
+        incremental_vector(const incremental_vector& v)     // copy
+            : alloc(alloc_traits::select_on_container_copy_construction(v.alloc)) { build([&] { append(v.begin(), v.end()); }); }
+        incremental_vector(incremental_vector&& v) noexcept // move
+            : alloc(std::move(v.alloc)) { create(); steal(v); }
+        ~incremental_vector() { uncreate(); }
+        incremental_vector& operator=(const incremental_vector&);   // copy assignment
+        incremental_vector& operator=(incremental_vector&&);        // move assignment
+        void assign( size_type count, const T& value );
+        allocator_type get_allocator() const { return alloc; };
+
+        // Element access
+        reference at( size_type i );
+        const_reference at( size_type i ) const;
+        T& operator[](size_type i) { return *slot(i); }
+        const T& operator[](size_type i) const { return *slot(i); }
+        reference front() { return *slot(0); }
+        const_reference front() const { return *slot(0); }
+        reference back() { return *slot(count - 1); }
+        const_reference back() const { return *slot(count - 1); }
+
+        // Iterators
+        iterator begin() noexcept { return iterator(this, 0); }
+        const_iterator begin() const noexcept { return const_iterator(this, 0); }
+        iterator end() noexcept { return iterator(this, count); }
+        const_iterator end() const noexcept { return const_iterator(this, count); }
+        reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+        const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); };
+        reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+        const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); };
+
+        // Capacity
+        bool empty() const { return count == 0; }
+        size_type size() const { return count; }
+        size_type capacity() const { return space; }
+        bool migrating() const { return old != nullptr; }  // elements are still left in the old block
+        void reserve( size_type new_cap );
+        void shrink_to_fit();
+
+        // Modifiers
+        void clear();
+        iterator insert( const_iterator pos, const T& value ) { return emplace(pos, value); }
+        template <class... Args>
+        iterator emplace( const_iterator pos, Args&&... args );
+        iterator erase( const_iterator pos ) { return erase(pos, pos + 1); }
+        iterator erase( const_iterator first, const_iterator last );
+        void push_back(const T& val) { emplace_back(val); }
+        void push_back(T&& val) { emplace_back(std::move(val)); }
+        template <class... Args>
+        reference emplace_back( Args&&... args );
+        void pop_back();
+        void resize( size_type count );
+        void resize( size_type count, const value_type& value );
+        void swap( incremental_vector& other ) noexcept;
+
+        // Operators
+        bool operator==(const incremental_vector& other) const;
+        bool operator!=(const incremental_vector& other) const { return !(*this == other); }
+        bool operator<(const incremental_vector& other) const;
+        bool operator>(const incremental_vector& other) const { return other < *this; }
+        bool operator>=(const incremental_vector& other) const { return !(*this < other); }
+        bool operator<=(const incremental_vector& other) const { return !(other < *this); }
+    private:
+        T* data;                // block new elements go to, of *space* elements
+        size_type count;        // number of elements
+        size_type space;        // capacity of data
+        T* old;                 // block being emptied, or null
+        size_type old_space;    // its capacity
+        size_type moved;        // elements [0, moved) are already in data,
+        size_type old_count;    // [moved, old_count) still in old, the rest in data
+
+        allocator_type alloc;
+
+        // Element *i*, in whichever block it is. Without a migration old_count
+        // and moved are 0, so the one unsigned comparison is false
+        T* slot( size_type i ) const { return i - moved < old_count - moved ? old + i : data + i; }
+
+        void create();          // set an empty vector without blocks
+        void uncreate();        // destroy the elements and release the blocks
+        template <class It>
+        void append(It, It);    // copy a range to the end
+        template <class Fill>
+        void build(Fill);       // fill a new vector, freeing it all if an element throws
+        void steal(incremental_vector&);    // take over the blocks of another vector
+        void destroy(T*, T*);   // destroy elements of a range backwards
+        T* relocate(T*, T*, T*);            // move a range to raw memory
+        void reallocate(size_type);         // move all elements to a block of given capacity
+        void start_migration(size_type);    // take a new block and keep the old one
+        void migrate();         // move the next few elements to the new block
+        void finish_migration();            // move all that is left in the old block
+        void release_old();     // give back the emptied old block
+};
+
+// Random access iterator which refers to an element by its index, so it stays
+// valid while the element moves from the old block to the new one
+template <class T, class Allocator>
+template <class Owner, class Value>
+class incremental_vector<T, Allocator>::basic_iterator {
+    public:
+        typedef std::random_access_iterator_tag iterator_category;
+        typedef std::remove_const_t<Value> value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef Value* pointer;
+        typedef Value& reference;
+
+        basic_iterator() = default;
+        basic_iterator(Owner* owner, size_type index) : owner(owner), index(index) {}
+        template <class O, class V, class = std::enable_if_t<std::is_const<Value>::value && !std::is_const<V>::value>>
+        basic_iterator(const basic_iterator<O, V>& it) : owner(it.owner), index(it.index) {}   // iterator to const_iterator
+        size_type position() const { return index; }
+
+        reference operator*() const { return (*owner)[index]; }
+        pointer operator->() const { return &(*owner)[index]; }
+        reference operator[](difference_type n) const { return (*owner)[index + n]; }
+        basic_iterator& operator++() { ++index; return *this; }
+        basic_iterator operator++(int) { basic_iterator it = *this; ++index; return it; }
+        basic_iterator& operator--() { --index; return *this; }
+        basic_iterator operator--(int) { basic_iterator it = *this; --index; return it; }
+        basic_iterator& operator+=(difference_type n) { index += n; return *this; }
+        basic_iterator& operator-=(difference_type n) { index -= n; return *this; }
+        basic_iterator operator+(difference_type n) const { return { owner, index + n }; }
+        basic_iterator operator-(difference_type n) const { return { owner, index - n }; }
+        friend basic_iterator operator+(difference_type n, const basic_iterator& it) { return it + n; }
+        difference_type operator-(const basic_iterator& other) const { return difference_type(index - other.index); }
+
+        bool operator==(const basic_iterator& other) const { return index == other.index; }
+        bool operator!=(const basic_iterator& other) const { return index != other.index; }
+        bool operator<(const basic_iterator& other) const { return index < other.index; }
+        bool operator>(const basic_iterator& other) const { return index > other.index; }
+        bool operator<=(const basic_iterator& other) const { return index <= other.index; }
+        bool operator>=(const basic_iterator& other) const { return index >= other.index; }
+    private:
+        template <class, class>
+        friend class basic_iterator;
+        Owner* owner = nullptr;
+        size_type index = 0;
+};
+
+// Set an empty vector without blocks
+template <class T, class Allocator>
+void incremental_vector<T, Allocator>::create() {
+    data = old = nullptr;
+    count = space = old_space = moved = old_count = 0;
+}
+
+// Destroy the elements and release both blocks
+template <class T, class Allocator>
+void incremental_vector<T, Allocator>::uncreate() {
+    clear();
+    if (data)
+        alloc_traits::deallocate(alloc, data, space);
+    create();
+}
+
+// Copy range [first, last) to the end of the vector
+template <class T, class Allocator>
+template <class It>
+void incremental_vector<T, Allocator>::append( It first, It last ) {
+    reserve(count + std::distance(first, last));
+    for (; first != last; ++first, ++count)
+        alloc_traits::construct(alloc, data + count, *first);
+}
+
+// Fill a vector under construction. Its destructor doesn't run if the
+// constructor throws, so the elements built so far and the block are
+// released here
+template <class T, class Allocator>
+template <class Fill>
+void incremental_vector<T, Allocator>::build( Fill fill ) {
+    create();
+    try {
+        fill();
+    } catch (...) {
+        uncreate();
+        throw;
+    }
+}
+
+// Take over the blocks of *other*, which is left empty
+template <class T, class Allocator>
+void incremental_vector<T, Allocator>::steal( incremental_vector& other ) {
+    data = other.data;
+    count = other.count;
+    space = other.space;
+    old = other.old;
+    old_space = other.old_space;
+    moved = other.moved;
+    old_count = other.old_count;
+    other.create();
+}
+
+// Destroy elements of range [first, last) backwards
+template <class T, class Allocator>
+void incremental_vector<T, Allocator>::destroy( T* first, T* last ) {
+    if constexpr (!std::is_trivially_destructible<T>::value)
+        while (last != first)
+            alloc_traits::destroy(alloc, --last);
+}
+
+// Move the elements of range [first, last) to raw memory at dest and end
+// their lifetime at the old place. Returns the end of the new range
+template <class T, class Allocator>
+T* incremental_vector<T, Allocator>::relocate( T* first, T* last, T* dest ) {
+    if constexpr (is_trivially_relocatable<T>::value) {
+        if (first != last)
+            std::memcpy(static_cast<void*>(dest), static_cast<const void*>(first),
+                        (last - first) * sizeof(T));
+        return dest + (last - first);
+    } else {
+        T* it = dest;
+        try {
+            for (T* i = first; i != last; ++i, ++it)
+                alloc_traits::construct(alloc, it, std::move_if_noexcept(*i));
+        } catch (...) {
+            destroy(dest, it);
+            throw;
+        }
+        destroy(first, last);
+        return it;
+    }
+}
+
+// Move all elements to a block of *new_cap* capacity at once
+template <class T, class Allocator>
+void incremental_vector<T, Allocator>::reallocate( size_type new_cap ) {
+    finish_migration();
+    T* new_data = new_cap ? alloc_traits::allocate(alloc, new_cap) : nullptr;
+    try {
+        relocate(data, data + count, new_data);
+    } catch (...) {
+        if (new_data)
+            alloc_traits::deallocate(alloc, new_data, new_cap);
+        throw;
+    }
+    if (data)
+        alloc_traits::deallocate(alloc, data, space);
+    data = new_data;
+    space = new_cap;
+}
+
+// Take a block of *new_cap* capacity for the new elements and keep the
+// current one, whose elements migrate() moves over later operations
+template <class T, class Allocator>
+void incremental_vector<T, Allocator>::start_migration( size_type new_cap ) {
+    T* new_data = alloc_traits::allocate(alloc, new_cap);
+    old = data;
+    old_space = space;
+    moved = 0;
+    old_count = count;
+    data = new_data;
+    space = new_cap;
+    if (old_count == 0)
+        release_old();
+}
+
+// Move up to *moves_per_operation* elements to their places in the new block
+template <class T, class Allocator>
+void incremental_vector<T, Allocator>::migrate() {
+    if (!old)
+        return;
+    size_type last = std::min(old_count, moved + moves_per_operation);
+    relocate(old + moved, old + last, data + moved);
+    moved = last;
+    if (moved == old_count)
+        release_old();
+}
+
+// Move everything left in the old block, i.e. before shifting elements
+template <class T, class Allocator>
+void incremental_vector<T, Allocator>::finish_migration() {
+    if (!old)
+        return;
+    relocate(old + moved, old + old_count, data + moved);
+    release_old();
+}
+
+template <class T, class Allocator>
+void incremental_vector<T, Allocator>::release_old() {
+    if (old)
+        alloc_traits::deallocate(alloc, old, old_space);
+    old = nullptr;
+    old_space = moved = old_count = 0;
+}
+
+// Assignment operator
+template <class T, class Allocator>
+incremental_vector<T, Allocator>& incremental_vector<T, Allocator>::operator=(const incremental_vector& rhs) {
+    if (&rhs != this) {
+        uncreate();
+        if constexpr (alloc_traits::propagate_on_container_copy_assignment::value)
+            alloc = rhs.alloc;  // The old blocks were released with the old allocator
+        append(rhs.begin(), rhs.end());
+    }
+    return *this;
+}
+
+// Move assignment operator, takes over the blocks of rhs if the allocators allow it
+template <class T, class Allocator>
+incremental_vector<T, Allocator>& incremental_vector<T, Allocator>::operator=(incremental_vector&& rhs) {
+    if (&rhs != this) {
+        uncreate();
+        if constexpr (alloc_traits::propagate_on_container_move_assignment::value)
+            alloc = std::move(rhs.alloc);
+        if (alloc_traits::propagate_on_container_move_assignment::value || alloc == rhs.alloc)
+            steal(rhs);
+        else {  // This allocator can't free rhs's blocks
+            append(std::make_move_iterator(rhs.begin()), std::make_move_iterator(rhs.end()));
+            rhs.clear();
+        }
+    }
+    return *this;
+}
+
+// Replace the contents with *count* copies of *value* value
+template <class T, class Allocator>
+void incremental_vector<T, Allocator>::assign( size_type count, const T& value ) {
+    if (count < 1)
+        throw std::invalid_argument{ "incremental_vector::assign" };
+    T copy(value);              // value may be an element of this vector
+    clear();
+    resize(count, copy);
+}
+
+// Element access funtions
+template <class T, class Allocator>
+typename incremental_vector<T, Allocator>::reference incremental_vector<T, Allocator>::at( size_type i ) {
+    if (i < size())
+        return *slot(i);
+    else throw std::out_of_range {"incremental_vector::at"};
+}
+
+template <class T, class Allocator>
+typename incremental_vector<T, Allocator>::const_reference incremental_vector<T, Allocator>::at( size_type i ) const {
+    if (i < size())
+        return *slot(i);
+    else throw std::out_of_range {"incremental_vector::at"};
+}
+
+// Reserve space for *new_cap* elements, relocating all of them at once
+template <class T, class Allocator>
+void incremental_vector<T, Allocator>::reserve( size_type new_cap ) {
+    if (new_cap > capacity())
+        reallocate(new_cap);
+}
+
+// Release unused memory, including the old block
+template <class T, class Allocator>
+void incremental_vector<T, Allocator>::shrink_to_fit() {
+    finish_migration();
+    if (count != space)
+        reallocate(count);
+}
+
+// Delete all elements, keep the new block
+template <class T, class Allocator>
+void incremental_vector<T, Allocator>::clear() {
+    if (old) {
+        destroy(data + old_count, data + count);
+        destroy(old + moved, old + old_count);
+        destroy(data, data + moved);
+        release_old();
+    } else destroy(data, data + count);
+    count = 0;
+}
+
+// Construct a new element in place before *pos* position
+template <class T, class Allocator>
+template <class... Args>
+typename incremental_vector<T, Allocator>::iterator incremental_vector<T, Allocator>::emplace( const_iterator pos, Args&&... args ) {
+    size_type offset = pos.position();
+    if (offset > count)
+        throw std::out_of_range{ "incremental_vector::emplace" };
+    if (offset == count) {
+        emplace_back(std::forward<Args>(args)...);
+        return iterator(this, offset);
+    }
+
+    T value(std::forward<Args>(args)...);   // args may refer to elements of this vector
+    if (count == space)
+        reallocate(grow_twice::grow(space, count + 1, sizeof(T)));
+    else finish_migration();
+    alloc_traits::construct(alloc, data + count, std::move(data[count - 1]));  // Move the last element to raw space
+    ++count;
+    std::move_backward(data + offset, data + count - 2, data + count - 1);    // Shift the rest by one position
+    data[offset] = std::move(value);
+    return iterator(this, offset);
+}
+
+// Erase elements in a range
+template <class T, class Allocator>
+typename incremental_vector<T, Allocator>::iterator incremental_vector<T, Allocator>::erase( const_iterator first, const_iterator last ) {
+    if (last < first)
+        throw std::invalid_argument{ "incremental_vector::erase" };
+    if (last.position() > count)
+        throw std::out_of_range{ "incremental_vector::erase" };
+    finish_migration();
+    T* new_end = std::move(data + last.position(), data + count, data + first.position());
+    destroy(new_end, data + count);
+    count = new_end - data;
+    return iterator(this, first.position());
+}
+
+// Construct a new element in place at the end of the vector, then move a
+// few elements of the old block, if there is one
+template <class T, class Allocator>
+template <class... Args>
+typename incremental_vector<T, Allocator>::reference incremental_vector<T, Allocator>::emplace_back( Args&&... args ) {
+    if (count == space) {
+        size_type new_cap = grow_twice::grow(space, count + 1, sizeof(T));
+        if (old) {      // Only if other operations kept the migration from finishing
+            T value(std::forward<Args>(args)...);
+            finish_migration();
+            start_migration(new_cap);
+            alloc_traits::construct(alloc, data + count, std::move(value));
+        } else {
+            start_migration(new_cap);   // args may refer into the old block, which stays
+            alloc_traits::construct(alloc, data + count, std::forward<Args>(args)...);
+        }
+    } else
+        alloc_traits::construct(alloc, data + count, std::forward<Args>(args)...);
+    ++count;
+    migrate();
+    return data[count - 1];
+}
+
+// Delete the last element of the vector
+template <class T, class Allocator>
+void incremental_vector<T, Allocator>::pop_back() {
+    alloc_traits::destroy(alloc, slot(count - 1));
+    --count;
+    if (count < old_count)      // The element was still waiting in the old block
+        old_count = count;
+    if (old && moved >= old_count)
+        release_old();
+    else migrate();
+}
+
+// Leave the vector with *count* elements only (count<size)
+template <class T, class Allocator>
+void incremental_vector<T, Allocator>::resize( size_type new_count ) {
+    if (new_count > size())
+        throw std::invalid_argument{ "incremental_vector::resize" };
+    finish_migration();
+    destroy(data + new_count, data + count);
+    count = new_count;
+}
+
+// If the current size is less than count, additional elements are
+// appended and initialized with copies of value
+template <class T, class Allocator>
+void incremental_vector<T, Allocator>::resize( size_type new_count, const value_type& value ) {
+    if (new_count <= count) {
+        resize(new_count);
+        return;
+    }
+    T copy(value);              // value may be an element of this vector
+    reserve(new_count);
+    finish_migration();
+    for (; count < new_count; ++count)
+        alloc_traits::construct(alloc, data + count, copy);
+}
+
+// Exchange the contents of the container with those of other
+template <class T, class Allocator>
+void incremental_vector<T, Allocator>::swap( incremental_vector& other ) noexcept {
+    if constexpr (alloc_traits::propagate_on_container_swap::value)
+        std::swap(alloc, other.alloc);
+    std::swap(data, other.data);
+    std::swap(count, other.count);
+    std::swap(space, other.space);
+    std::swap(old, other.old);
+    std::swap(old_space, other.old_space);
+    std::swap(moved, other.moved);
+    std::swap(old_count, other.old_count);
+}
+
+// Compare element by element; vectors which aren't migrating are compared
+// as contiguous ranges, like vector does
+template <class T, class Allocator>
+bool incremental_vector<T, Allocator>::operator==(const incremental_vector& other) const {
+    if (count != other.count)
+        return false;
+    if (!old && !other.old)
+        return equal_elements(data, other.data, count);
+    return std::equal(begin(), end(), other.begin());
+}
+
+template <class T, class Allocator>
+bool incremental_vector<T, Allocator>::operator<(const incremental_vector& other) const {
+    if (!old && !other.old)
+        return compare_elements(data, count, other.data, other.count) < 0;
+    return std::lexicographical_compare(begin(), end(), other.begin(), other.end());
+}
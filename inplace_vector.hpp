@@ -0,0 +1,414 @@
+#pragma once
+
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// Storage of inplace_vector. Trivial types live in a plain array, so the
+// container is trivially copyable and usable in constant expressions
+template <class T, size_t N, bool = std::is_trivial<T>::value>
+struct inplace_storage {
+#if __cpp_constexpr >= 201907L
+    T elems[N ? N : 1];
+#else
+    // C++17 constant expressions need every member initialized, and may not
+    // switch a union to the array later, so construction zeroes all N elements
+    T elems[N ? N : 1] = {};
+#endif
+    size_t count = 0;
+
+    constexpr T* ptr() { return elems; }
+    constexpr const T* ptr() const { return elems; }
+    template <class... Args>
+    constexpr void construct( size_t i, Args&&... args ) { elems[i] = T(std::forward<Args>(args)...); }
+    constexpr void destroy( size_t ) {}
+};
+
+// Storage of other types: raw memory, elements are created and destroyed in place
+template <class T, size_t N>
+struct inplace_storage<T, N, false> {
+    alignas(T) unsigned char bytes[(N ? N : 1) * sizeof(T)];
+    size_t count = 0;
+
+    inplace_storage() = default;
+    inplace_storage(const inplace_storage& other) { append(other.ptr(), other.ptr() + other.count); }
+    inplace_storage(inplace_storage&& other) noexcept(std::is_nothrow_move_constructible<T>::value) {
+        append(std::make_move_iterator(other.ptr()), std::make_move_iterator(other.ptr() + other.count));
+    }
+    ~inplace_storage() { clear(); }
+    inplace_storage& operator=(const inplace_storage& other) {
+        if (&other != this) {
+            clear();
+            append(other.ptr(), other.ptr() + other.count);
+        }
+        return *this;
+    }
+    inplace_storage& operator=(inplace_storage&& other) noexcept(std::is_nothrow_move_constructible<T>::value) {
+        if (&other != this) {
+            clear();
+            append(std::make_move_iterator(other.ptr()), std::make_move_iterator(other.ptr() + other.count));
+        }
+        return *this;
+    }
+
+    T* ptr() { return std::launder(reinterpret_cast<T*>(bytes)); }
+    const T* ptr() const { return std::launder(reinterpret_cast<const T*>(bytes)); }
+    template <class... Args>
+    void construct( size_t i, Args&&... args ) { ::new(static_cast<void*>(ptr() + i)) T(std::forward<Args>(args)...); }
+    void destroy( size_t i ) { ptr()[i].~T(); }
+    void clear() {
+        while (count)
+            destroy(--count);
+    }
+    template <class It>
+    void append( It first, It last ) {
+        try {
+            for (; first != last; ++first, ++count)
+                construct(count, *first);
+        } catch (...) {
+            clear();            // Constructors don't run the destructor on failure
+            throw;
+        }
+    }
+};
+
+// Vector with a fixed capacity of N elements stored inside the object.
+// Never allocates: growing past N throws std::length_error, or fails
+// with a null pointer in try_push_back() and try_emplace_back().
+// Has the same interface as vector and works in constant expressions for trivial T
+template <class T, size_t N>
+class inplace_vector {
+    public:
+        // Member types
+        typedef T value_type;
+        typedef size_t size_type;
+        typedef value_type& reference;
+        typedef const value_type& const_reference;
+        typedef T* iterator;
+        typedef const T* const_iterator;
+        typedef std::reverse_iterator<iterator> reverse_iterator;
+        typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+        // Member functions
+        constexpr inplace_vector() noexcept {}
+        constexpr explicit inplace_vector(size_type n, const T& val = T{}) { insert(end(), n, val); }
+        constexpr inplace_vector(std::initializer_list<T> array); // Create from array
+        constexpr void assign( size_type count, const T& value );
+
+        // Element access
+        constexpr reference at( size_type i );
+        constexpr const_reference at( size_type i ) const;
+        constexpr T& operator[](size_type i) { return buffer.ptr()[i]; }
+        constexpr const T& operator[](size_type i) const { return buffer.ptr()[i]; }
+        constexpr reference front() { return *begin(); }
+        constexpr const_reference front() const { return *begin(); }
+        constexpr reference back() { return *(end()-1); }
+        constexpr const_reference back() const { return *(end()-1); }
+
+        // Iterators
+        constexpr iterator begin() noexcept { return buffer.ptr(); }
+        constexpr const_iterator begin() const noexcept { return buffer.ptr(); }
+        constexpr iterator end() noexcept { return buffer.ptr() + buffer.count; }
+        constexpr const_iterator end() const noexcept { return buffer.ptr() + buffer.count; }
+        constexpr reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+        constexpr const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); };
+        constexpr reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+        constexpr const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); };
+
+        // Capacity
+        constexpr bool empty() const { return buffer.count == 0; }
+        constexpr size_type size() const { return buffer.count; }
+        static constexpr size_type capacity() { return N; }
+        static constexpr size_type max_size() { return N; }
+        constexpr void reserve( size_type new_cap );
+        constexpr void shrink_to_fit() {}
+
+        // Modifiers
+        constexpr void clear();
+        constexpr iterator insert( const_iterator pos, const T& value );
+        constexpr iterator insert( const_iterator pos, size_type count, const T& value );
+        template <class... Args>
+        constexpr iterator emplace( const_iterator pos, Args&&... args );
+        constexpr iterator erase( iterator pos );
+        constexpr iterator erase( iterator first, iterator last );
+        constexpr void push_back(const T& val);
+        constexpr void push_back(T&& val);
+        template <class... Args>
+        constexpr reference emplace_back( Args&&... args );
+        constexpr T* try_push_back(const T& val);
+        constexpr T* try_push_back(T&& val);
+        template <class... Args>
+        constexpr T* try_emplace_back( Args&&... args );
+        constexpr void pop_back();
+        constexpr void resize( size_type count );
+        constexpr void resize( size_type count, const value_type& value );
+        constexpr void swap( inplace_vector& other );
+
+        // Operators
+        constexpr bool operator==(const inplace_vector& other) const;
+        constexpr bool operator!=(const inplace_vector& other) const;
+        constexpr bool operator<(const inplace_vector& other) const;
+        constexpr bool operator>(const inplace_vector& other) const;
+        constexpr bool operator>=(const inplace_vector& other) const;
+        constexpr bool operator<=(const inplace_vector& other) const;
+    private:
+        inplace_storage<T, N> buffer;   // elements and their count
+
+        constexpr void check_room( size_type count, const char* where ) const; // throw if count more don't fit
+};
+
+// Create a vector from an array
+template <class T, size_t N>
+constexpr inplace_vector<T, N>::inplace_vector(std::initializer_list<T> array) {
+    check_room(array.size(), "inplace_vector::inplace_vector");
+    for (const T& value : array) {
+        buffer.construct(buffer.count, value);
+        ++buffer.count;         // Counted only once built, for the destructor
+    }
+}
+
+// Throw if *count* more elements don't fit into the capacity
+template <class T, size_t N>
+constexpr void inplace_vector<T, N>::check_room( size_type count, const char* where ) const {
+    if (count > N - buffer.count)
+        throw std::length_error{ where };
+}
+
+// Replace the contents with *count* copies of *value* value
+template <class T, size_t N>
+constexpr void inplace_vector<T, N>::assign( size_type count, const T& value ) {
+    if (count < 1)
+        throw std::invalid_argument{ "inplace_vector::assign" };
+    if (count > N)
+        throw std::length_error{ "inplace_vector::assign" };
+    T copy(value);              // value may be an element of this vector
+    clear();
+    insert(end(), count, copy);
+}
+
+// Element access funtions
+template <class T, size_t N>
+constexpr typename inplace_vector<T, N>::reference inplace_vector<T, N>::at( size_type i ) {
+    if (i < size())
+        return (*this)[i];
+    else throw std::out_of_range {"inplace_vector::at"};
+}
+
+template <class T, size_t N>
+constexpr typename inplace_vector<T, N>::const_reference inplace_vector<T, N>::at( size_type i ) const {
+    if (i < size())
+        return (*this)[i];
+    else throw std::out_of_range {"inplace_vector::at"};
+}
+
+// The capacity is fixed, only check that *new_cap* fits into it
+template <class T, size_t N>
+constexpr void inplace_vector<T, N>::reserve( size_type new_cap ) {
+    if (new_cap > N)
+        throw std::length_error{ "inplace_vector::reserve" };
+}
+
+// Delete all elements
+template <class T, size_t N>
+constexpr void inplace_vector<T, N>::clear() {
+    while (buffer.count)
+        buffer.destroy(--buffer.count);
+}
+
+// Insert *value* at *pos* position
+template <class T, size_t N>
+constexpr typename inplace_vector<T, N>::iterator inplace_vector<T, N>::insert( const_iterator pos, const T& value ) {
+    return emplace(pos, value);
+}
+
+// Insert *count* copies of *value* at *pos* position
+template <class T, size_t N>
+constexpr typename inplace_vector<T, N>::iterator inplace_vector<T, N>::insert( const_iterator pos, size_type count, const T& value ) {
+    if (pos < begin() || pos > end())
+        throw std::out_of_range{ "inplace_vector::insert" };
+    check_room(count, "inplace_vector::insert");
+    size_type offset = pos - begin();
+    T copy(value);              // value may be an element of this vector
+
+    // Elements are appended, then rotated into place one position at a time
+    size_type old_size = size();
+    for (size_type i = 0; i < count; ++i, ++buffer.count)
+        buffer.construct(buffer.count, copy);
+    iterator it = begin() + offset;
+    if (offset != old_size) {
+        for (size_type i = old_size; i-- > offset; )    // Shift the tail right by count
+            (*this)[i + count] = std::move((*this)[i]);
+        for (size_type i = 0; i < count; ++i)
+            it[i] = copy;
+    }
+    return it;
+}
+
+// Construct a new element in place before *pos* position
+template <class T, size_t N>
+template <class... Args>
+constexpr typename inplace_vector<T, N>::iterator inplace_vector<T, N>::emplace( const_iterator pos, Args&&... args ) {
+    if (pos < begin() || pos > end())
+        throw std::out_of_range{ "inplace_vector::emplace" };
+    check_room(1, "inplace_vector::emplace");
+    size_type offset = pos - begin();
+    if (offset == size()) {
+        buffer.construct(buffer.count, std::forward<Args>(args)...);
+        ++buffer.count;
+        return begin() + offset;
+    }
+
+    T value(std::forward<Args>(args)...);   // args may refer to elements of this vector
+    buffer.construct(buffer.count, std::move(back())); // Move the last element to raw space
+    ++buffer.count;
+    for (size_type i = size() - 2; i > offset; --i) // Shift the rest by one position
+        (*this)[i] = std::move((*this)[i - 1]);
+    (*this)[offset] = std::move(value);
+    return begin() + offset;
+}
+
+// Erase element at pos position
+template <class T, size_t N>
+constexpr typename inplace_vector<T, N>::iterator inplace_vector<T, N>::erase( iterator pos ) {
+    if (pos < begin() || pos >= end())
+        throw std::out_of_range{ "inplace_vector::erase" };
+    return erase(pos, pos + 1);
+}
+
+// Erase elements in a range
+template <class T, size_t N>
+constexpr typename inplace_vector<T, N>::iterator inplace_vector<T, N>::erase( iterator first, iterator last ) {
+    if (last < first)
+        throw std::invalid_argument{ "inplace_vector::erase" };
+    if (first < begin() || last > end())
+        throw std::out_of_range{ "inplace_vector::erase" };
+    iterator it = first;
+    for (iterator i = last; i != end(); ++i, ++it)  // Move the tail left
+        *it = std::move(*i);
+    resize(it - begin());
+    return first;
+}
+
+// Add an element to the back of the vector
+template <class T, size_t N>
+constexpr void inplace_vector<T, N>::push_back(const T& val){
+    emplace_back(val);
+}
+
+// Move an element to the back of the vector
+template <class T, size_t N>
+constexpr void inplace_vector<T, N>::push_back(T&& val){
+    emplace_back(std::move(val));
+}
+
+// Construct a new element in place at the end of the vector
+template <class T, size_t N>
+template <class... Args>
+constexpr typename inplace_vector<T, N>::reference inplace_vector<T, N>::emplace_back( Args&&... args ) {
+    check_room(1, "inplace_vector::emplace_back");
+    buffer.construct(buffer.count, std::forward<Args>(args)...);
+    return (*this)[buffer.count++];
+}
+
+// Add an element to the back, if there is room for it. Returns
+// a pointer to the new element, or nullptr if the vector is full
+template <class T, size_t N>
+constexpr T* inplace_vector<T, N>::try_push_back(const T& val){
+    return try_emplace_back(val);
+}
+
+template <class T, size_t N>
+constexpr T* inplace_vector<T, N>::try_push_back(T&& val){
+    return try_emplace_back(std::move(val));
+}
+
+template <class T, size_t N>
+template <class... Args>
+constexpr T* inplace_vector<T, N>::try_emplace_back( Args&&... args ) {
+    if (buffer.count == N)
+        return nullptr;
+    buffer.construct(buffer.count, std::forward<Args>(args)...);
+    return begin() + buffer.count++;
+}
+
+// Delete the last element of the vector
+template <class T, size_t N>
+constexpr void inplace_vector<T, N>::pop_back(){
+    buffer.destroy(--buffer.count);
+}
+
+// Leave the vector with *count* elements only (count<size)
+template <class T, size_t N>
+constexpr void inplace_vector<T, N>::resize( size_type count ) {
+    if (count > size())
+        throw std::invalid_argument{ "inplace_vector::resize" };
+    while (buffer.count != count)
+        buffer.destroy(--buffer.count);
+}
+
+// If the current size is less than count, additional elements are
+// appended and initialized with copies of value
+template <class T, size_t N>
+constexpr void inplace_vector<T, N>::resize( size_type count, const value_type& value ) {
+    if (size() > count)
+        resize(count);
+    else
+        insert(end(), count - size(), value);
+}
+
+// Exchange the contents of the container with those of other.
+// Elements are swapped one by one, it takes linear time
+template <class T, size_t N>
+constexpr void inplace_vector<T, N>::swap( inplace_vector& other ) {
+    inplace_vector temp(std::move(other));
+    other = std::move(*this);
+    *this = std::move(temp);
+}
+
+// Check if both vectors have the same size and values
+template <class T, size_t N>
+constexpr bool inplace_vector<T, N>::operator==(const inplace_vector& other) const {
+    if (size() != other.size())
+        return false;
+    for (size_type i = 0; i < size(); i++)
+        if (!((*this)[i] == other[i]))
+            return false;
+    return true;
+}
+
+template <class T, size_t N>
+constexpr bool inplace_vector<T, N>::operator!=(const inplace_vector& other) const {
+    return !(*this == other);
+}
+
+// Compare vectors lexicographically
+template <class T, size_t N>
+constexpr bool inplace_vector<T, N>::operator<(const inplace_vector& other) const {
+    size_type smaller_size = size() < other.size() ? size() : other.size();
+    for (size_type i = 0; i < smaller_size; i++) {
+        if ((*this)[i] < other[i])
+            return true;
+        if (other[i] < (*this)[i])
+            return false;
+    }
+    return size() < other.size();
+}
+
+template <class T, size_t N>
+constexpr bool inplace_vector<T, N>::operator>(const inplace_vector& other) const {
+    return other < *this;
+}
+
+template <class T, size_t N>
+constexpr bool inplace_vector<T, N>::operator<=(const inplace_vector& other) const {
+    return !(other < *this);
+}
+
+template <class T, size_t N>
+constexpr bool inplace_vector<T, N>::operator>=(const inplace_vector& other) const {
+    return !(*this < other);
+}
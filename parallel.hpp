@@ -0,0 +1,516 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+// Bulk operations of vector spread over several threads: a work stealing
+// pool of workers shared by the whole program, constructors of ranges split
+// into chunks and algorithms on random access ranges
+namespace parallel {
+
+class pool;
+
+// How many threads a bulk operation may use: seq runs it on the calling
+// thread, par on every hardware thread, policy{ n } on at most n threads.
+// The threads are those of *workers*, or of the program's pool if it's null
+struct policy {
+    unsigned threads;
+    pool* workers = nullptr;
+};
+
+constexpr policy seq{ 1 };
+constexpr policy par{ 0 };
+
+// Chunks smaller than this aren't worth handing to another thread
+constexpr size_t min_chunk_bytes = size_t(256) << 10;
+constexpr size_t cache_line = 64;
+
+// Worker threads which run tasks for the thread that asked for them. Each
+// worker queues the batches of tasks it starts itself and takes the newest
+// first, while idle workers steal the oldest from the others' queues. A
+// thread waiting for its tasks runs queued ones meanwhile, so tasks may
+// start tasks
+class pool {
+    public:
+        explicit pool(unsigned workers);
+        ~pool();
+        pool(const pool&) = delete;
+        pool& operator=(const pool&) = delete;
+
+        // The pool of the program, with a worker for each hardware thread but one
+        static pool& instance();
+
+        // Number of threads tasks run on: the workers and the calling thread
+        unsigned size() const { return worker_count + 1; }
+
+        // Call task(k) for each k in [0, count) on up to *threads* threads and
+        // return when all are done. If tasks throw, the first exception is
+        // rethrown here after the rest have finished
+        template <class Task>
+        void run( size_t count, Task&& task, unsigned threads = 0 );
+
+    private:
+        struct batch {      // Tasks of one run(), shared with the workers which help
+            std::function<void(size_t)> task;
+            size_t count;
+            std::atomic<size_t> next{ 0 }, done{ 0 };
+            std::exception_ptr error;
+            std::mutex lock;
+            std::condition_variable finished;
+            void work();    // run tasks until none are left
+        };
+
+        struct queue {      // Batches a thread asked help with, newest at the back
+            std::mutex lock;
+            std::deque<std::shared_ptr<batch>> batches;
+        };
+
+        const unsigned worker_count;        // Set before the workers start, unlike workers.size()
+        std::vector<std::thread> workers;
+        std::unique_ptr<queue[]> queues;    // One per worker, the last for threads outside the pool
+        std::atomic<size_t> queued{ 0 };    // Batches in all queues, or a few more for a moment
+        std::mutex lock;
+        std::condition_variable wake;
+        bool stopping = false;
+
+        static std::pair<const pool*, unsigned>& current();    // pool and queue of the calling thread
+        unsigned home() const;              // queue of the calling thread in this pool
+        void serve(unsigned index);         // loop of a worker
+        bool help(unsigned home);           // run a queued batch, false if there is none
+};
+
+// Start *workers* threads
+inline pool::pool( unsigned workers_count ) : worker_count(workers_count), queues(new queue[workers_count + 1]) {
+    workers.reserve(workers_count);
+    for (unsigned i = 0; i < workers_count; ++i)
+        workers.emplace_back([this, i] { serve(i); });
+}
+
+// Let the workers finish what they run and stop them
+inline pool::~pool() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers)
+        worker.join();
+}
+
+inline pool& pool::instance() {
+    static pool shared(std::max(std::thread::hardware_concurrency(), 1u) - 1);
+    return shared;
+}
+
+// Run tasks of the batch until none are left to take
+inline void pool::batch::work() {
+    for (size_t k; (k = next++) < count; ) {
+        try {
+            task(k);
+        } catch (...) {
+            std::lock_guard<std::mutex> guard(lock);
+            if (!error)
+                error = std::current_exception();
+        }
+        if (++done == count) {
+            std::lock_guard<std::mutex> guard(lock);
+            finished.notify_all();
+        }
+    }
+}
+
+inline std::pair<const pool*, unsigned>& pool::current() {
+    static thread_local std::pair<const pool*, unsigned> self{ nullptr, 0 };
+    return self;
+}
+
+inline unsigned pool::home() const {
+    const auto& self = current();
+    return self.first == this ? self.second : worker_count;
+}
+
+inline void pool::serve( unsigned index ) {
+    current() = { this, index };
+    while (true) {
+        if (help(index))
+            continue;
+        std::unique_lock<std::mutex> guard(lock);
+        wake.wait(guard, [this] { return stopping || queued > 0; });
+        if (stopping && queued == 0)
+            return;
+    }
+}
+
+// Take the newest batch of our own queue, or else steal the oldest of another
+inline bool pool::help( unsigned home ) {
+    std::shared_ptr<batch> next;
+    {
+        std::lock_guard<std::mutex> guard(queues[home].lock);
+        if (!queues[home].batches.empty()) {
+            next = std::move(queues[home].batches.back());
+            queues[home].batches.pop_back();
+        }
+    }
+    for (unsigned i = 1; !next && i <= worker_count; ++i) {
+        queue& victim = queues[(home + i) % (worker_count + 1)];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (!victim.batches.empty()) {
+            next = std::move(victim.batches.front());
+            victim.batches.pop_front();
+        }
+    }
+    if (!next)
+        return false;
+    --queued;
+    next->work();
+    return true;
+}
+
+template <class Task>
+void pool::run( size_t count, Task&& task, unsigned threads ) {
+    if (threads == 0 || threads > size())
+        threads = size();
+    size_t helpers = std::min<size_t>(threads - 1, count ? count - 1 : 0);
+    if (helpers == 0) {
+        for (size_t k = 0; k < count; ++k)
+            task(k);
+        return;
+    }
+    auto tasks = std::make_shared<batch>();
+    tasks->task = std::ref(task);
+    tasks->count = count;
+    unsigned self = home();
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        queued += helpers;      // Before the batches show up, so it never drops below their number
+    }
+    {
+        std::lock_guard<std::mutex> guard(queues[self].lock);
+        for (size_t i = 0; i < helpers; ++i)
+            queues[self].batches.push_back(tasks);  // Workers which come late find nothing left
+    }
+    if (helpers == 1)
+        wake.notify_one();
+    else wake.notify_all();
+    tasks->work();
+    // Others still run their tasks: help with other batches, i.e. the ones
+    // those tasks started, instead of blocking a thread they may need
+    while (tasks->done < count)
+        if (!help(self)) {
+            std::unique_lock<std::mutex> guard(tasks->lock);
+            tasks->finished.wait_for(guard, std::chrono::milliseconds(1), [&] { return tasks->done == count; });
+        }
+    if (tasks->error)
+        std::rethrow_exception(tasks->error);
+}
+
+// Pool the threads of *p* come from
+inline pool& pool_of( policy p ) {
+    return p.workers ? *p.workers : pool::instance();
+}
+
+// Bytes of a core's L2 cache as the system reports it, 1 MB if it doesn't
+inline size_t l2_cache_bytes() {
+    static const size_t bytes = [] {
+#ifdef _SC_LEVEL2_CACHE_SIZE
+        long reported = sysconf(_SC_LEVEL2_CACHE_SIZE);
+        if (reported > 0)
+            return size_t(reported);
+#endif
+        return size_t(1) << 20;
+    }();
+    return bytes;
+}
+
+// Number of threads a bulk operation on *bytes* bytes is split across
+inline unsigned pieces( policy p, size_t bytes ) {
+    if (p.threads == 1 || bytes < 2 * min_chunk_bytes)
+        return 1;
+    unsigned threads = p.threads ? p.threads : pool_of(p).size();   // Chunks beyond the pool's threads queue up
+    return unsigned(std::max<size_t>(std::min<size_t>(threads, bytes / min_chunk_bytes), 1));
+}
+
+// Build [first, first + n) in *count* chunks on several threads: build(begin, end)
+// constructs a chunk, or destroys what it built of it and throws. Chunks
+// start on cache lines where elements do, so threads don't share lines. If
+// any chunk throws, the finished ones are destroyed and the exception rethrown
+template <class T, class Build>
+void construct_chunks( policy p, T* first, size_t n, unsigned count, Build build ) {
+    if (count <= 1) {
+        build(first, first + n);
+        return;
+    }
+    size_t step = cache_line / std::gcd(cache_line, sizeof(T));   // Elements in a whole number of lines
+    size_t skew = 0;    // Elements before the first which starts a line
+    while (skew < step && (reinterpret_cast<uintptr_t>(first + skew) % cache_line) != 0)
+        ++skew;
+    if (skew == step)
+        skew = 0;
+    auto bound = [&](size_t k) {
+        return k == count ? n : std::min(n, k == 0 ? 0 : skew + n / count * k / step * step);
+    };
+    std::unique_ptr<std::atomic<bool>[]> built(new std::atomic<bool>[count]);
+    for (unsigned k = 0; k < count; ++k)
+        built[k] = false;
+    try {
+        pool_of(p).run(count, [&](size_t k) {
+            build(first + bound(k), first + bound(k + 1));
+            built[k] = true;
+        }, count);
+    } catch (...) {
+        for (unsigned k = 0; k < count; ++k)
+            if (built[k])
+                std::destroy(first + bound(k), first + bound(k + 1));
+        throw;
+    }
+}
+
+// Construct copies of *value* in raw memory [first, last)
+template <class T>
+void uninitialized_fill( policy p, T* first, T* last, const T& value ) {
+    size_t n = last - first;
+    construct_chunks(p, first, n, pieces(p, n * sizeof(T)), [&](T* begin, T* end) {
+        std::uninitialized_fill(begin, end, value);
+    });
+}
+
+// Construct copies of [first, last) in raw memory at dest, returns the end of the copy
+template <class T>
+T* uninitialized_copy( policy p, const T* first, const T* last, T* dest ) {
+    size_t n = last - first;
+    construct_chunks(p, dest, n, pieces(p, n * sizeof(T)), [&](T* begin, T* end) {
+        const T* from = first + (begin - dest);
+        if constexpr (std::is_trivially_copyable<T>::value) {
+            if (end != begin)
+                std::memcpy(static_cast<void*>(begin), static_cast<const void*>(from), (end - begin) * sizeof(T));
+        } else std::uninitialized_copy(from, from + (end - begin), begin);
+    });
+    return dest + n;
+}
+
+
+// Algorithms on random access ranges, i.e. of vector, in the order of std::
+// ones with a policy first: sort(parallel::par, v.begin(), v.end())
+
+// Tasks a range of *n* elements of *size* bytes is split into: about half an
+// L2 cache each, so a task's elements stay in its core's cache while it
+// works on them, and at least one for each thread which may take part
+inline size_t tasks( policy p, size_t n, size_t size ) {
+    unsigned threads = pieces(p, n * size);
+    if (threads <= 1)
+        return 1;
+    size_t grain = std::max<size_t>(l2_cache_bytes() / 2, cache_line);
+    return std::min(n, std::max<size_t>(threads, n * size / grain));
+}
+
+// Call body(k, begin, end) for the *count* tasks over [0, n), on the threads of *p*
+template <class Body>
+void for_chunks( policy p, size_t n, size_t count, Body&& body ) {
+    if (count <= 1) {
+        body(size_t(0), size_t(0), n);
+        return;
+    }
+    pool_of(p).run(count, [&](size_t k) {
+        body(k, n * k / count, n * (k + 1) / count);
+    }, p.threads);
+}
+
+// Call f on each element of [first, last)
+template <class It, class Function>
+void for_each( policy p, It first, It last, Function f ) {
+    size_t n = last - first;
+    for_chunks(p, n, tasks(p, n, sizeof(*first)), [&](size_t, size_t begin, size_t end) {
+        std::for_each(first + begin, first + end, std::ref(f));
+    });
+}
+
+// Store op(x) for each x of [first, last) at out, returns the end of the results
+template <class It, class Out, class Operation>
+Out transform( policy p, It first, It last, Out out, Operation op ) {
+    size_t n = last - first;
+    for_chunks(p, n, tasks(p, n, sizeof(*first) + sizeof(*out)), [&](size_t, size_t begin, size_t end) {
+        std::transform(first + begin, first + end, out + begin, std::ref(op));
+    });
+    return out + n;
+}
+
+// Store op(x, y) for pairs of [first1, last1) and the range at first2 at out
+template <class It1, class It2, class Out, class Operation>
+Out transform( policy p, It1 first1, It1 last1, It2 first2, Out out, Operation op ) {
+    size_t n = last1 - first1;
+    for_chunks(p, n, tasks(p, n, sizeof(*first1) + sizeof(*first2) + sizeof(*out)), [&](size_t, size_t begin, size_t end) {
+        std::transform(first1 + begin, first1 + end, first2 + begin, out + begin, std::ref(op));
+    });
+    return out + n;
+}
+
+// Combine *init* and [first, last) with op, which has to be associative
+// since each task combines its own part of the range first
+template <class It, class T, class Operation = std::plus<>>
+T reduce( policy p, It first, It last, T init, Operation op = {} ) {
+    size_t n = last - first, count = tasks(p, n, sizeof(*first));
+    if (count <= 1)
+        return std::accumulate(first, last, std::move(init), op);
+    std::vector<std::optional<T>> partial(count);
+    for_chunks(p, n, count, [&](size_t k, size_t begin, size_t end) {
+        T sum = first[begin];
+        for (size_t i = begin + 1; i < end; ++i)
+            sum = op(std::move(sum), first[i]);
+        partial[k] = std::move(sum);
+    });
+    for (std::optional<T>& sum : partial)
+        init = op(std::move(init), std::move(*sum));
+    return init;
+}
+
+// Store the running totals of [first, last) under an associative op at out,
+// which may be first. Returns the end of the results. The range is read
+// twice: once for the totals of the tasks' parts, once for the running totals
+template <class It, class Out, class Operation = std::plus<>>
+Out inclusive_scan( policy p, It first, It last, Out out, Operation op = {} ) {
+    using T = typename std::iterator_traits<It>::value_type;
+    size_t n = last - first, count = tasks(p, n, sizeof(*first) + sizeof(*out));
+    if (count <= 1)
+        return std::partial_sum(first, last, out, op);
+    std::vector<std::optional<T>> carry(count);     // Total of the parts before each one
+    for_chunks(p, n, count, [&](size_t k, size_t begin, size_t end) {
+        if (k + 1 == count)
+            return;
+        T sum = first[begin];
+        for (size_t i = begin + 1; i < end; ++i)
+            sum = op(std::move(sum), first[i]);
+        carry[k + 1] = std::move(sum);
+    });
+    for (size_t k = 2; k < count; ++k)
+        carry[k] = op(std::move(*carry[k - 1]), std::move(*carry[k]));
+    for_chunks(p, n, count, [&](size_t k, size_t begin, size_t end) {
+        T sum = k ? op(*carry[k], first[begin]) : T(first[begin]);
+        out[begin] = sum;
+        for (size_t i = begin + 1; i < end; ++i) {
+            sum = op(std::move(sum), first[i]);
+            out[i] = sum;
+        }
+    });
+    return out + n;
+}
+
+// Number of elements of a among the first d of the stable merge of sorted
+// a[0, na) and b[0, nb): the merge splits into parts at any output position
+template <class It, class Compare>
+size_t merge_split( It a, size_t na, It b, size_t nb, size_t d, Compare& comp ) {
+    size_t low = d > nb ? d - nb : 0, high = std::min(d, na);
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (comp(b[d - mid - 1], a[mid]))
+            high = mid;
+        else low = mid + 1;     // a[mid] goes before b[d - mid - 1]
+    }
+    return low;
+}
+
+// Sort a run of [first, last) for each thread, then merge pairs of sorted
+// blocks back and forth between the range and a buffer, each merge split
+// into parts for the threads. The merges are stable, so are stable runs
+template <class It, class Compare>
+void sort_runs( policy p, It first, It last, Compare comp, bool stable ) {
+    using T = typename std::iterator_traits<It>::value_type;
+    size_t n = last - first;
+    unsigned runs = pieces(p, n * sizeof(T));
+    if (runs <= 1) {
+        if (stable)
+            std::stable_sort(first, last, comp);
+        else std::sort(first, last, comp);
+        return;
+    }
+    pool& threads = pool_of(p);
+    std::vector<size_t> edges(runs + 1);
+    for (unsigned k = 0; k <= runs; ++k)
+        edges[k] = n * k / runs;
+    threads.run(runs, [&](size_t k) {
+        if (stable)
+            std::stable_sort(first + edges[k], first + edges[k + 1], comp);
+        else std::sort(first + edges[k], first + edges[k + 1], comp);
+    }, p.threads);
+
+    struct scratch {    // Raw memory for the merges, with moved elements once built
+        T* data;
+        size_t n;
+        bool built = false;
+        ~scratch() {
+            if (built)
+                std::destroy(data, data + n);
+            std::allocator<T>().deallocate(data, n);
+        }
+    } buffer{ std::allocator<T>().allocate(n), n };
+    construct_chunks(p, buffer.data, n, runs, [&](T* begin, T* end) {
+        std::uninitialized_move(first + (begin - buffer.data), first + (end - buffer.data), begin);
+    });
+    buffer.built = true;
+
+    struct part { size_t out, a, a_end, b, b_end; };   // Merge of [a, a_end) and [b, b_end) at out
+    auto merge_round = [&](auto src, auto dst, size_t width) {
+        std::vector<part> parts;
+        for (size_t i = 0; i < runs; i += 2 * width) {
+            size_t lo = edges[i], mid = edges[std::min<size_t>(i + width, runs)];
+            size_t hi = edges[std::min<size_t>(i + 2 * width, runs)];
+            size_t count = std::max<size_t>((hi - lo) * runs / n, 1), d = 0, a = 0;   // Parts as long as runs
+            for (size_t k = 1; k <= count; ++k) {
+                size_t next_d = (hi - lo) * k / count;
+                size_t next_a = merge_split(src + lo, mid - lo, src + mid, hi - mid, next_d, comp);
+                parts.push_back({ lo + d, lo + a, lo + next_a, mid + d - a, mid + next_d - next_a });
+                d = next_d;
+                a = next_a;
+            }
+        }
+        threads.run(parts.size(), [&](size_t k) {
+            const part& m = parts[k];
+            std::merge(std::make_move_iterator(src + m.a), std::make_move_iterator(src + m.a_end),
+                       std::make_move_iterator(src + m.b), std::make_move_iterator(src + m.b_end), dst + m.out, comp);
+        }, p.threads);
+    };
+    bool in_buffer = true;     // The sorted runs were moved there
+    for (size_t width = 1; width < runs; width *= 2) {
+        if (in_buffer)
+            merge_round(buffer.data, first, width);
+        else merge_round(first, buffer.data, width);
+        in_buffer = !in_buffer;
+    }
+    if (in_buffer)
+        for_chunks(p, n, runs, [&](size_t, size_t begin, size_t end) {
+            std::move(buffer.data + begin, buffer.data + end, first + begin);
+        });
+}
+
+// Sort [first, last) with comp, equal elements in any order
+template <class It, class Compare = std::less<>>
+void sort( policy p, It first, It last, Compare comp = {} ) {
+    sort_runs(p, first, last, comp, false);
+}
+
+// Sort [first, last) with comp, keeping the order of equal elements
+template <class It, class Compare = std::less<>>
+void stable_sort( policy p, It first, It last, Compare comp = {} ) {
+    sort_runs(p, first, last, comp, true);
+}
+
+}
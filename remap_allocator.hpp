@@ -0,0 +1,123 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// Allocator which can grow a block without copying its contents.
+// Small blocks come from malloc and are resized with realloc, blocks of at least
+// *remap_threshold* bytes are mapped pages resized with mremap (Linux only).
+// vector uses reallocate() only for trivially relocatable element types
+template <class T>
+class remap_allocator {
+        static_assert(alignof(T) <= alignof(std::max_align_t), "remap_allocator: over-aligned type");
+    public:
+        typedef T value_type;
+        typedef size_t size_type;
+        static constexpr size_type remap_threshold = size_type(1) << 20; // 1 MiB
+
+        remap_allocator() noexcept = default;
+        template <class U>
+        remap_allocator(const remap_allocator<U>&) noexcept {}
+
+        T* allocate( size_type n );
+        void deallocate( T* p, size_type n ) noexcept;
+        T* reallocate( T* p, size_type old_n, size_type new_n );
+
+        template <class U>
+        bool operator==(const remap_allocator<U>&) const noexcept { return true; }
+        template <class U>
+        bool operator!=(const remap_allocator<U>&) const noexcept { return false; }
+    private:
+        static bool is_mapped( size_type n ) { return n * sizeof(T) >= remap_threshold; }
+        static size_type mapped_size( size_type n );    // bytes rounded up to whole pages
+};
+
+#ifdef __linux__
+
+template <class T>
+typename remap_allocator<T>::size_type remap_allocator<T>::mapped_size( size_type n ) {
+    static const size_type page = sysconf(_SC_PAGESIZE);
+    return (n * sizeof(T) + page - 1) / page * page;
+}
+
+// Allocate space for *n* objects
+template <class T>
+T* remap_allocator<T>::allocate( size_type n ) {
+    if (n > size_type(-1) / sizeof(T))
+        throw std::bad_array_new_length{};
+    void* p;
+    if (is_mapped(n)) {
+        p = mmap(nullptr, mapped_size(n), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED)
+            throw std::bad_alloc{};
+    } else if (!(p = std::malloc(n * sizeof(T))))
+        throw std::bad_alloc{};
+    return static_cast<T*>(p);
+}
+
+// Release space of *n* objects, allocated by allocate() or reallocate()
+template <class T>
+void remap_allocator<T>::deallocate( T* p, size_type n ) noexcept {
+    if (is_mapped(n))
+        munmap(p, mapped_size(n));
+    else std::free(p);
+}
+
+// Resize the block at *p* from *old_n* to *new_n* objects, keeping its bytes.
+// Mapped blocks are remapped by the kernel, so no pages are copied
+template <class T>
+T* remap_allocator<T>::reallocate( T* p, size_type old_n, size_type new_n ) {
+    if (new_n > size_type(-1) / sizeof(T))
+        throw std::bad_array_new_length{};
+    void* q;
+    if (is_mapped(old_n) && is_mapped(new_n)) {
+        q = mremap(p, mapped_size(old_n), mapped_size(new_n), MREMAP_MAYMOVE);
+        if (q == MAP_FAILED)
+            throw std::bad_alloc{};
+    } else if (!is_mapped(old_n) && !is_mapped(new_n)) {
+        if (!(q = std::realloc(p, new_n * sizeof(T))))
+            throw std::bad_alloc{};
+    } else {    // The block crosses the threshold, copy it once
+        q = allocate(new_n);
+        std::memcpy(q, static_cast<void*>(p), std::min(old_n, new_n) * sizeof(T));
+        deallocate(p, old_n);
+    }
+    return static_cast<T*>(q);
+}
+
+#else   // No page remapping, rely on realloc only
+
+template <class T>
+T* remap_allocator<T>::allocate( size_type n ) {
+    if (n > size_type(-1) / sizeof(T))
+        throw std::bad_array_new_length{};
+    void* p = std::malloc(n * sizeof(T));
+    if (!p)
+        throw std::bad_alloc{};
+    return static_cast<T*>(p);
+}
+
+template <class T>
+void remap_allocator<T>::deallocate( T* p, size_type ) noexcept {
+    std::free(p);
+}
+
+template <class T>
+T* remap_allocator<T>::reallocate( T* p, size_type, size_type new_n ) {
+    if (new_n > size_type(-1) / sizeof(T))
+        throw std::bad_array_new_length{};
+    void* q = std::realloc(p, new_n * sizeof(T));
+    if (!q)
+        throw std::bad_alloc{};
+    return static_cast<T*>(q);
+}
+
+#endif
@@ -0,0 +1,528 @@
+#pragma once
+
+#include "vector.hpp"
+
+inline namespace VECTOR_STATS_NAMESPACE {    // holds a vector, see vector_stats.hpp
+
+// Smallest power of two of *bytes* sized elements which fills a cache line
+constexpr size_t line_elements( size_t bytes ) {
+    size_t n = 1;
+    while (n * bytes < 64)
+        n *= 2;
+    return n;
+}
+
+// Vector which never moves its elements: it grows by adding blocks, each
+// twice as large as the one before, and keeps a table of them. Element i
+// is found from the highest bit of i, so access is O(1) without a search.
+// Pointers and references to elements stay valid until the element is
+// erased, however the vector grows; insert() and erase() shift values
+// between slots as vector does. Trailing blocks are freed once the vector
+// shrinks past them, keeping one spare so pop_back and push_back don't
+// alternate between freeing and allocating a block. Iterators are
+// invalidated by insert(), erase() and anything that changes the size
+template <class T, class Allocator = std::allocator<T>>
+class segmented_vector {
+        template <class Owner, class Value>
+        class basic_iterator;   // element of a vector, with its block cached
+    public:
+        // Member types
+        typedef T value_type;
+        typedef Allocator allocator_type;
+        typedef std::allocator_traits<Allocator> alloc_traits;
+        typedef size_t size_type;
+        typedef value_type& reference;
+        typedef const value_type& const_reference;
+        typedef basic_iterator<segmented_vector, T> iterator;
+        typedef basic_iterator<const segmented_vector, const T> const_iterator;
+        typedef std::reverse_iterator<iterator> reverse_iterator;
+        typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+        // Elements of the first block, at least a cache line of them; a power of two
+        static constexpr size_type first_block = line_elements(sizeof(T));
+
+        // Member functions
+        segmented_vector() noexcept(noexcept(Allocator())) : alloc(), blocks() { create(); }
+        explicit segmented_vector(const Allocator& a) noexcept : alloc(a), blocks(table_allocator(a)) { create(); }
+        explicit segmented_vector(size_type n, const T& val = T{}, const Allocator& a = Allocator())
+            : alloc(a), blocks(table_allocator(a)) { build([&] { resize(n, val); }); }
+        segmented_vector(std::initializer_list<T> array, const Allocator& a = Allocator()) // Create from array
+            : alloc(a), blocks(table_allocator(a)) { build([&] { append(array.begin(), array.end()); }); }
+        segmented_vector(const segmented_vector& v)     // copy
+            : alloc(alloc_traits::select_on_container_copy_construction(v.alloc)), blocks(table_allocator(alloc))
+            { build([&] { append(v.begin(), v.end()); }); }
+        segmented_vector(segmented_vector&& v) noexcept // move
+            : alloc(std::move(v.alloc)), blocks(std::move(v.blocks)), count(v.count), avail(v.avail), limit(v.limit)
+            { v.create(); }
+        ~segmented_vector() { uncreate(); }
+        segmented_vector& operator=(const segmented_vector&);   // copy assignment
+        segmented_vector& operator=(segmented_vector&&);        // move assignment
+        void assign( size_type count, const T& value );
+        allocator_type get_allocator() const { return alloc; };
+
+        // Element access
+        reference at( size_type i );
+        const_reference at( size_type i ) const;
+        T& operator[](size_type i) { return *slot(i); }
+        const T& operator[](size_type i) const { return *slot(i); }
+        reference front() { return *blocks[0]; }
+        const_reference front() const { return *blocks[0]; }
+        reference back() { return *slot(count - 1); }
+        const_reference back() const { return *slot(count - 1); }
+
+        // Iterators
+        iterator begin() noexcept { return iterator(this, 0); }
+        const_iterator begin() const noexcept { return const_iterator(this, 0); }
+        iterator end() noexcept { return iterator(this, count); }
+        const_iterator end() const noexcept { return const_iterator(this, count); }
+        reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+        const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); };
+        reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+        const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); };
+
+        // Capacity
+        bool empty() const { return count == 0; }
+        size_type size() const { return count; }
+        size_type capacity() const { return block_start(blocks.size()); }
+        size_type block_count() const { return blocks.size(); }
+        void reserve( size_type new_cap );
+        void shrink_to_fit();
+
+        // Modifiers
+        void clear();
+        iterator insert( const_iterator pos, const T& value ) { return emplace(pos, value); }
+        template <class... Args>
+        iterator emplace( const_iterator pos, Args&&... args );
+        iterator erase( const_iterator pos ) { return erase(pos, pos + 1); }
+        iterator erase( const_iterator first, const_iterator last );
+        void push_back(const T& val) { emplace_back(val); }
+        void push_back(T&& val) { emplace_back(std::move(val)); }
+        template <class... Args>
+        reference emplace_back( Args&&... args );
+        void pop_back();
+        void resize( size_type count );
+        void resize( size_type count, const value_type& value );
+        void swap( segmented_vector& other ) noexcept;
+
+        // Operators
+        bool operator==(const segmented_vector& other) const;
+#ifdef __cpp_lib_three_way_comparison
+        // !=, <, >, <= and >= are rewritten by the compiler in terms of these two
+        auto operator<=>(const segmented_vector& other) const;
+#else
+        bool operator!=(const segmented_vector& other) const { return !(*this == other); }
+        bool operator<(const segmented_vector& other) const { return compare(other) < 0; }
+        bool operator>(const segmented_vector& other) const { return compare(other) > 0; }
+        bool operator>=(const segmented_vector& other) const { return compare(other) >= 0; }
+        bool operator<=(const segmented_vector& other) const { return compare(other) <= 0; }
+#endif
+    private:
+        typedef typename alloc_traits::template rebind_alloc<T*> table_allocator;
+
+        allocator_type alloc;
+        vector<T*, table_allocator> blocks;     // block k holds elements [block_start(k), block_start(k + 1))
+        size_type count;        // number of elements
+        T* avail;               // slot of the next push_back, or null if its block isn't there yet
+        T* limit;               // end of avail's block
+
+        static size_type block_size( size_type k ) { return first_block << k; }
+        static size_type block_start( size_type k ) { return (first_block << k) - first_block; }
+        static size_type block_of( size_type i );  // block which holds element *i*
+        T* slot( size_type i ) const {              // element *i*
+            size_type k = block_of(i);
+            return blocks[k] + (i - block_start(k));
+        }
+        size_type used( size_type k ) const {       // elements in block *k*
+            return count <= block_start(k) ? 0 : std::min(count - block_start(k), block_size(k));
+        }
+
+        void create();          // set an empty vector without blocks
+        void uncreate();        // destroy the elements and free the blocks
+        template <class It>
+        void append(It, It);    // copy a range to the end
+        template <class Fill>
+        void build(Fill);       // fill a new vector, freeing it all if an element throws
+        void add_block();       // allocate the next block
+        void seek_tail();       // point avail and limit at the slot after the last element
+        void shrink(size_type); // destroy elements from the given index on
+        void trim(size_type);   // free blocks past the ones in use and the given number of spares
+#ifndef __cpp_lib_three_way_comparison
+        int compare(const segmented_vector&) const;    // <0, 0 or >0 as the vector is less, equal or greater
+#endif
+};
+
+}
+
+// Random access iterator which keeps a pointer into the current block, so
+// stepping through a block costs as much as with vector's pointers
+template <class T, class Allocator>
+template <class Owner, class Value>
+class segmented_vector<T, Allocator>::basic_iterator {
+    public:
+        typedef std::random_access_iterator_tag iterator_category;
+        typedef std::remove_const_t<Value> value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef Value* pointer;
+        typedef Value& reference;
+
+        basic_iterator() = default;
+        basic_iterator(Owner* owner, size_type index) : owner(owner), index(index) { seek(); }
+        template <class O, class V, class = std::enable_if_t<std::is_const<Value>::value && !std::is_const<V>::value>>
+        basic_iterator(const basic_iterator<O, V>& it)     // iterator to const_iterator
+            : owner(it.owner), index(it.index), element(it.element), first(it.first), last(it.last) {}
+        size_type position() const { return index; }
+
+        reference operator*() const { return *element; }
+        pointer operator->() const { return element; }
+        reference operator[](difference_type n) const { return (*owner)[index + n]; }
+        basic_iterator& operator++() {
+            ++index;
+            if (++element == last)
+                seek();         // Into the next block
+            return *this;
+        }
+        basic_iterator operator++(int) { basic_iterator it = *this; ++*this; return it; }
+        basic_iterator& operator--() {
+            --index;
+            if (element == first)
+                seek();
+            else --element;
+            return *this;
+        }
+        basic_iterator operator--(int) { basic_iterator it = *this; --*this; return it; }
+        basic_iterator& operator+=(difference_type n) { index += n; seek(); return *this; }
+        basic_iterator& operator-=(difference_type n) { index -= n; seek(); return *this; }
+        basic_iterator operator+(difference_type n) const { return basic_iterator(owner, index + n); }
+        basic_iterator operator-(difference_type n) const { return basic_iterator(owner, index - n); }
+        friend basic_iterator operator+(difference_type n, const basic_iterator& it) { return it + n; }
+        difference_type operator-(const basic_iterator& other) const { return difference_type(index - other.index); }
+
+        bool operator==(const basic_iterator& other) const { return index == other.index; }
+        bool operator!=(const basic_iterator& other) const { return index != other.index; }
+        bool operator<(const basic_iterator& other) const { return index < other.index; }
+        bool operator>(const basic_iterator& other) const { return index > other.index; }
+        bool operator<=(const basic_iterator& other) const { return index <= other.index; }
+        bool operator>=(const basic_iterator& other) const { return index >= other.index; }
+    private:
+        template <class, class>
+        friend class basic_iterator;
+        Owner* owner = nullptr;
+        size_type index = 0;
+        Value* element = nullptr;   // element *index*, null past the allocated blocks
+        Value* first = nullptr;     // its block
+        Value* last = nullptr;
+
+        void seek() {
+            size_type k = block_of(index);
+            if (k < owner->blocks.size()) {
+                first = owner->blocks[k];
+                element = first + (index - block_start(k));
+                last = first + block_size(k);
+            } else element = first = last = nullptr;
+        }
+};
+
+// Block which holds element *i*: blocks grow twice, so it is the highest
+// bit of i / first_block + 1
+template <class T, class Allocator>
+typename segmented_vector<T, Allocator>::size_type segmented_vector<T, Allocator>::block_of( size_type i ) {
+    size_type n = i / first_block + 1;
+#if defined(__GNUC__)
+    return size_type(63 - __builtin_clzll((unsigned long long)n));
+#else
+    size_type k = 0;
+    while (n >>= 1)
+        ++k;
+    return k;
+#endif
+}
+
+// Set an empty vector without blocks
+template <class T, class Allocator>
+void segmented_vector<T, Allocator>::create() {
+    count = 0;
+    avail = limit = nullptr;
+}
+
+// Destroy the elements and free all blocks
+template <class T, class Allocator>
+void segmented_vector<T, Allocator>::uncreate() {
+    clear();
+    trim(0);
+    create();
+}
+
+// Copy range [first, last) to the end of the vector
+template <class T, class Allocator>
+template <class It>
+void segmented_vector<T, Allocator>::append( It first, It last ) {
+    reserve(count + std::distance(first, last));
+    for (; first != last; ++first)
+        emplace_back(*first);
+}
+
+// Fill a vector under construction. Its destructor doesn't run if the
+// constructor throws, so the elements built so far and the blocks are
+// released here
+template <class T, class Allocator>
+template <class Fill>
+void segmented_vector<T, Allocator>::build( Fill fill ) {
+    create();
+    try {
+        fill();
+    } catch (...) {
+        uncreate();
+        throw;
+    }
+}
+
+// Allocate the next block, twice as large as the last
+template <class T, class Allocator>
+void segmented_vector<T, Allocator>::add_block() {
+    blocks.reserve(blocks.size() + 1);      // The table can't fail to take the new block
+    blocks.push_back(alloc_traits::allocate(alloc, block_size(blocks.size())));
+}
+
+// Point avail and limit at the slot of the next push_back
+template <class T, class Allocator>
+void segmented_vector<T, Allocator>::seek_tail() {
+    size_type k = block_of(count);
+    if (k < blocks.size()) {
+        avail = blocks[k] + (count - block_start(k));
+        limit = blocks[k] + block_size(k);
+    } else avail = limit = nullptr;
+}
+
+// Destroy elements [new_count, count) backwards and make *new_count* the size
+template <class T, class Allocator>
+void segmented_vector<T, Allocator>::shrink( size_type new_count ) {
+    if constexpr (!std::is_trivially_destructible<T>::value)
+        for (size_type k = blocks.size(); k-- > 0 && block_start(k) + used(k) > new_count; ) {
+            T* block = blocks[k];
+            for (size_type i = used(k); i > 0 && block_start(k) + i > new_count; --i)
+                alloc_traits::destroy(alloc, block + i - 1);
+        }
+    count = new_count;
+    seek_tail();
+}
+
+// Free the blocks past those which hold elements, but *spare* of them
+template <class T, class Allocator>
+void segmented_vector<T, Allocator>::trim( size_type spare ) {
+    size_type keep = (count ? block_of(count - 1) + 1 : 0) + spare;
+    while (blocks.size() > keep) {
+        alloc_traits::deallocate(alloc, blocks.back(), block_size(blocks.size() - 1));
+        blocks.pop_back();
+    }
+    seek_tail();
+}
+
+// Assignment operator
+template <class T, class Allocator>
+segmented_vector<T, Allocator>& segmented_vector<T, Allocator>::operator=(const segmented_vector& rhs) {
+    if (&rhs != this) {
+        if constexpr (alloc_traits::propagate_on_container_copy_assignment::value) {
+            if (alloc != rhs.alloc)
+                uncreate();     // The blocks must be freed with the old allocator
+            alloc = rhs.alloc;
+        }
+        clear();                // Keep the blocks
+        append(rhs.begin(), rhs.end());
+    }
+    return *this;
+}
+
+// Move assignment operator, takes over the blocks of rhs if the allocators allow it
+template <class T, class Allocator>
+segmented_vector<T, Allocator>& segmented_vector<T, Allocator>::operator=(segmented_vector&& rhs) {
+    if (&rhs != this) {
+        uncreate();
+        if constexpr (alloc_traits::propagate_on_container_move_assignment::value)
+            alloc = std::move(rhs.alloc);
+        if (alloc_traits::propagate_on_container_move_assignment::value || alloc == rhs.alloc) {
+            blocks.swap(rhs.blocks);
+            count = rhs.count;
+            avail = rhs.avail;
+            limit = rhs.limit;
+            rhs.create();
+        } else {  // This allocator can't free rhs's blocks
+            append(std::make_move_iterator(rhs.begin()), std::make_move_iterator(rhs.end()));
+            rhs.clear();
+        }
+    }
+    return *this;
+}
+
+// Replace the contents with *count* copies of *value* value
+template <class T, class Allocator>
+void segmented_vector<T, Allocator>::assign( size_type count, const T& value ) {
+    if (count < 1)
+        throw std::invalid_argument{ "segmented_vector::assign" };
+    T copy(value);              // value may be an element of this vector
+    clear();
+    resize(count, copy);
+}
+
+// Element access funtions
+template <class T, class Allocator>
+typename segmented_vector<T, Allocator>::reference segmented_vector<T, Allocator>::at( size_type i ) {
+    if (i < size())
+        return *slot(i);
+    else throw std::out_of_range {"segmented_vector::at"};
+}
+
+template <class T, class Allocator>
+typename segmented_vector<T, Allocator>::const_reference segmented_vector<T, Allocator>::at( size_type i ) const {
+    if (i < size())
+        return *slot(i);
+    else throw std::out_of_range {"segmented_vector::at"};
+}
+
+// Add blocks until *new_cap* elements fit. Nothing moves
+template <class T, class Allocator>
+void segmented_vector<T, Allocator>::reserve( size_type new_cap ) {
+    if (new_cap <= capacity())
+        return;
+    while (capacity() < new_cap)
+        add_block();
+    seek_tail();
+}
+
+// Free the blocks past the last element
+template <class T, class Allocator>
+void segmented_vector<T, Allocator>::shrink_to_fit() {
+    trim(0);
+}
+
+// Delete all elements, keep the blocks
+template <class T, class Allocator>
+void segmented_vector<T, Allocator>::clear() {
+    shrink(0);
+}
+
+// Construct a new element before *pos* position: it is added at the end and
+// rotated into place, so the values after it shift by one slot
+template <class T, class Allocator>
+template <class... Args>
+typename segmented_vector<T, Allocator>::iterator segmented_vector<T, Allocator>::emplace( const_iterator pos, Args&&... args ) {
+    size_type offset = pos.position();
+    if (offset > count)
+        throw std::out_of_range{ "segmented_vector::emplace" };
+    emplace_back(std::forward<Args>(args)...);  // No element moves, args may refer to any of them
+    std::rotate(begin() + offset, end() - 1, end());
+    return begin() + offset;
+}
+
+// Erase elements in a range, the values after it shift into their slots
+template <class T, class Allocator>
+typename segmented_vector<T, Allocator>::iterator segmented_vector<T, Allocator>::erase( const_iterator first, const_iterator last ) {
+    if (last < first)
+        throw std::invalid_argument{ "segmented_vector::erase" };
+    if (last.position() > count)
+        throw std::out_of_range{ "segmented_vector::erase" };
+    size_type offset = first.position();
+    iterator new_end = std::move(begin() + last.position(), end(), begin() + offset);
+    shrink(new_end.position());
+    trim(1);
+    return begin() + offset;
+}
+
+// Construct a new element in place at the end of the vector, adding a
+// block when the last one is full
+template <class T, class Allocator>
+template <class... Args>
+typename segmented_vector<T, Allocator>::reference segmented_vector<T, Allocator>::emplace_back( Args&&... args ) {
+    if (avail == limit) {
+        if (block_of(count) == blocks.size())
+            add_block();
+        seek_tail();
+    }
+    alloc_traits::construct(alloc, avail, std::forward<Args>(args)...);
+    ++count;
+    return *avail++;
+}
+
+// Delete the last element of the vector
+template <class T, class Allocator>
+void segmented_vector<T, Allocator>::pop_back() {
+    shrink(count - 1);
+    if (blocks.size() > block_of(count) + 2)   // Two empty blocks at the end, free one
+        trim(1);
+}
+
+// Leave the vector with *count* elements only (count<size)
+template <class T, class Allocator>
+void segmented_vector<T, Allocator>::resize( size_type new_count ) {
+    if (new_count > size())
+        throw std::invalid_argument{ "segmented_vector::resize" };
+    shrink(new_count);
+    trim(1);
+}
+
+// If the current size is less than count, additional elements are
+// appended and initialized with copies of value
+template <class T, class Allocator>
+void segmented_vector<T, Allocator>::resize( size_type new_count, const value_type& value ) {
+    if (new_count <= count) {
+        resize(new_count);
+        return;
+    }
+    T copy(value);              // value may be an element of this vector
+    reserve(new_count);
+    while (count < new_count)
+        emplace_back(copy);
+}
+
+// Exchange the contents of the container with those of other
+template <class T, class Allocator>
+void segmented_vector<T, Allocator>::swap( segmented_vector& other ) noexcept {
+    if constexpr (alloc_traits::propagate_on_container_swap::value)
+        std::swap(alloc, other.alloc);
+    blocks.swap(other.blocks);
+    std::swap(count, other.count);
+    std::swap(avail, other.avail);
+    std::swap(limit, other.limit);
+}
+
+// Vectors of one type have blocks of the same sizes, so they are compared
+// block by block with vector's kernels
+template <class T, class Allocator>
+bool segmented_vector<T, Allocator>::operator==(const segmented_vector& other) const {
+    if (count != other.count)
+        return false;
+    for (size_type k = 0; k < blocks.size() && used(k); ++k)
+        if (!equal_elements(blocks[k], other.blocks[k], used(k)))
+            return false;
+    return true;
+}
+
+#ifdef __cpp_lib_three_way_comparison
+// Compare vectors lexicographically, block by block, by the first elements
+// which are not equal
+template <class T, class Allocator>
+auto segmented_vector<T, Allocator>::operator<=>(const segmented_vector& other) const {
+    typedef decltype(synth_three_way(std::declval<const T&>(), std::declval<const T&>())) ordering;
+    for (size_type k = 0; ; ++k) {
+        size_type n = k < blocks.size() ? used(k) : 0, m = k < other.blocks.size() ? other.used(k) : 0;
+        size_type common = std::min(n, m);
+        size_type i = common ? mismatch_index(blocks[k], other.blocks[k], common) : 0;
+        if (i < common)
+            return ordering(synth_three_way(blocks[k][i], other.blocks[k][i]));
+        if (n != m || n == 0)   // One vector ends in this block
+            return ordering(count <=> other.count);
+    }
+}
+#else
+// Lexicographical comparison block by block. The first block where the
+// vectors differ in an element or in length decides
+template <class T, class Allocator>
+int segmented_vector<T, Allocator>::compare( const segmented_vector& other ) const {
+    for (size_type k = 0; ; ++k) {
+        size_type n = k < blocks.size() ? used(k) : 0, m = k < other.blocks.size() ? other.used(k) : 0;
+        if (n == 0 || m == 0)
+            return n < m ? -1 : n > m;
+        if (int result = compare_elements(blocks[k], n, other.blocks[k], m))
+            return result;
+    }
+}
+#endif
@@ -0,0 +1,540 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <type_traits>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#define SIMD_SSE2 1
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(SIMD_SSE2)
+#include <cpuid.h>
+#endif
+
+// Kernels for newer instruction sets are built next to the SSE2 ones and
+// picked at run time, so one binary runs on any x86-64 CPU. GCC and Clang
+// only, elsewhere they are used if the whole program is compiled for them
+#if defined(SIMD_SSE2) && defined(__GNUC__)
+#define SIMD_DISPATCH 1
+#define SIMD_AVX2 __attribute__((target("avx2")))
+#define SIMD_AVX512 __attribute__((target("avx512f,avx512bw")))
+#else
+#if defined(__AVX2__)
+#define SIMD_AVX2
+#endif
+#if defined(__AVX512F__) && defined(__AVX512BW__)
+#define SIMD_AVX512
+#endif
+#endif
+
+// Inline every call of a kernel whose inner calls are generic code, i.e. the
+// nodes of an expression, so that they end up compiled for the kernel's target
+#if defined(__GNUC__)
+#define SIMD_FLATTEN __attribute__((flatten))
+#else
+#define SIMD_FLATTEN
+#endif
+
+// Vectorized kernels behind the bulk operations of vector. Each one has
+// a portable scalar loop and SSE2, AVX2 and AVX-512 versions, which are
+// chosen by the level the CPU supports or the VECTOR_SIMD_LEVEL variable
+namespace simd {
+
+// Instruction sets the kernels are built for, from the oldest
+enum class level { scalar, sse2, avx2, avx512 };
+
+inline const char* level_name( level l ) {
+    static const char* const names[] = { "scalar", "sse2", "avx2", "avx512" };
+    return names[int(l)];
+}
+
+// Level named *name* (as level_name() gives), or *fallback* if there is none
+inline level parse_level( const char* name, level fallback ) {
+    for (int l = 0; l <= int(level::avx512); ++l)
+        if (name && std::strcmp(name, level_name(level(l))) == 0)
+            return level(l);
+    return fallback;
+}
+
+// The newest level both the CPU and the operating system support, checked once
+inline level detect_level() {
+#if defined(SIMD_SSE2)
+    static const level detected = [] {
+        unsigned regs[4] = {};     // eax, ebx, ecx, edx
+#if defined(_MSC_VER)
+        __cpuidex(reinterpret_cast<int*>(regs), 1, 0);
+#else
+        __cpuid_count(1, 0, regs[0], regs[1], regs[2], regs[3]);
+#endif
+        bool xsave = regs[2] & (1u << 27), avx = regs[2] & (1u << 28);
+        if (!xsave || !avx)
+            return level::sse2;
+        // Registers the OS saves on context switches: XMM, YMM (bits 1, 2), opmask and ZMM (bits 5-7)
+#if defined(_MSC_VER)
+        unsigned long long xcr0 = _xgetbv(0);
+        __cpuidex(reinterpret_cast<int*>(regs), 7, 0);
+#else
+        unsigned xcr0_low, xcr0_high;
+        __asm__("xgetbv" : "=a"(xcr0_low), "=d"(xcr0_high) : "c"(0));
+        unsigned long long xcr0 = (unsigned long long)xcr0_high << 32 | xcr0_low;
+        __cpuid_count(7, 0, regs[0], regs[1], regs[2], regs[3]);
+#endif
+        bool avx2 = regs[1] & (1u << 5), avx512f = regs[1] & (1u << 16), avx512bw = regs[1] & (1u << 30);
+        if ((xcr0 & 0x6) != 0x6 || !avx2)
+            return level::sse2;
+        if ((xcr0 & 0xE6) != 0xE6 || !avx512f || !avx512bw)
+            return level::avx2;
+        return level::avx512;
+    }();
+    return detected;
+#else
+    return level::scalar;
+#endif
+}
+
+// The level in use: detect_level() or the older one VECTOR_SIMD_LEVEL names
+inline std::atomic<level>& level_setting() {
+    static std::atomic<level> setting{ std::min(parse_level(std::getenv("VECTOR_SIMD_LEVEL"), level::avx512), detect_level()) };
+    return setting;
+}
+
+inline level active_level() {
+    return level_setting().load(std::memory_order_relaxed);
+}
+
+// Use kernels of level *l*, or of the newest supported one if the CPU lacks *l*
+inline void set_level( level l ) {
+    level_setting().store(std::min(l, detect_level()), std::memory_order_relaxed);
+}
+
+// Function pointers to the versions of one kernel, indexed by level. Levels
+// which weren't compiled (nullptr) use the version of the level below.
+// Tables are static const, not constexpr: compilers still fill them in at
+// compile time, but sanitizers which check the pointer comparisons can't, and
+// initialize them on first use instead
+template <class F>
+struct dispatch_table {
+    F kernels[4];
+    constexpr dispatch_table( F scalar, F sse2, F avx2, F avx512 )
+        : kernels{ scalar, sse2 ? sse2 : scalar, avx2 ? avx2 : sse2 ? sse2 : scalar,
+                   avx512 ? avx512 : avx2 ? avx2 : sse2 ? sse2 : scalar } {}
+    F operator()() const { return kernels[int(active_level())]; }
+};
+
+#if defined(SIMD_SSE2)
+#define SIMD_IF_SSE2(kernel) kernel
+#else
+#define SIMD_IF_SSE2(kernel) nullptr
+#endif
+#if defined(SIMD_AVX2)
+#define SIMD_IF_AVX2(kernel) kernel
+#else
+#define SIMD_IF_AVX2(kernel) nullptr
+#endif
+#if defined(SIMD_AVX512)
+#define SIMD_IF_AVX512(kernel) kernel
+#else
+#define SIMD_IF_AVX512(kernel) nullptr
+#endif
+
+// Index of the lowest set bit of a non-zero mask
+inline unsigned first_bit( unsigned long long mask ) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, mask);
+    return index;
+#else
+    return __builtin_ctzll(mask);
+#endif
+}
+
+// Number of set bits of a mask
+inline unsigned bit_count( unsigned long long mask ) {
+#if defined(__GNUC__)
+    return __builtin_popcountll(mask);
+#else
+    unsigned count = 0;
+    for (; mask; mask &= mask - 1)
+        ++count;
+    return count;
+#endif
+}
+
+// Tells whether the kernels handle T: integers, enums and floating
+// point numbers, which fill whole SIMD lanes
+template <class T>
+struct is_searchable : std::integral_constant<bool,
+    ((std::is_integral<T>::value || std::is_enum<T>::value) && (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8))
+    || std::is_same<T, float>::value || std::is_same<T, double>::value> {};
+
+// Number of values find_any_of() compares each block with at once
+constexpr size_t max_values = 8;
+
+// Call kernel(std::integral_constant<size_t, count>), so that kernels
+// can keep all values in registers. *count* is from 1 to max_values
+template <size_t Count = 1, class Kernel>
+size_t with_count( size_t count, Kernel kernel ) {
+    if constexpr (Count < max_values)
+        if (count != Count)
+            return with_count<Count + 1>(count, kernel);
+    return kernel(std::integral_constant<size_t, Count>());
+}
+
+// Integer of the same size as T, to broadcast T's bits
+template <class T>
+using lane_bits = typename std::conditional<sizeof(T) == 1, uint8_t,
+                  typename std::conditional<sizeof(T) == 2, uint16_t,
+                  typename std::conditional<sizeof(T) == 4, uint32_t, uint64_t>::type>::type>::type;
+
+template <class T>
+lane_bits<T> bits_of( const T& value ) {
+    lane_bits<T> bits;
+    std::memcpy(&bits, &value, sizeof(T));
+    return bits;
+}
+
+// Scalar kernels, for CPUs without SSE2 and as the reference for the others
+
+template <class T>
+size_t mismatch_scalar( const T* a, const T* b, size_t n ) {
+    for (size_t i = 0; i < n; ++i)
+        if (!(a[i] == b[i]))
+            return i;
+    return n;
+}
+
+template <class T, size_t Count>
+size_t find_scalar( const T* p, size_t n, const T* values ) {
+    if constexpr (Count == 1)
+        return std::find(p, p + n, values[0]) - p;
+    for (size_t i = 0; i < n; ++i)
+        for (size_t k = 0; k < Count; ++k)
+            if (p[i] == values[k])
+                return i;
+    return n;
+}
+
+template <class T>
+size_t count_scalar( const T* p, size_t n, T value ) {
+    size_t result = 0;
+    for (size_t i = 0; i < n; ++i)
+        result += p[i] == value;
+    return result;
+}
+
+#if defined(SIMD_SSE2)
+// Copy *value* to every lane of a vector
+template <class T>
+__m128i splat( T value ) {
+    lane_bits<T> bits = bits_of(value);
+    if constexpr (sizeof(T) == 1)
+        return _mm_set1_epi8(char(bits));
+    else if constexpr (sizeof(T) == 2)
+        return _mm_set1_epi16(short(bits));
+    else if constexpr (sizeof(T) == 4)
+        return _mm_set1_epi32(int(bits));
+    else return _mm_set1_epi64x((long long)bits);
+}
+
+// Set every byte of the lanes of x and y which are equal as T
+template <class T>
+__m128i equal_lanes( __m128i x, __m128i y ) {
+    if constexpr (std::is_same<T, float>::value)
+        return _mm_castps_si128(_mm_cmpeq_ps(_mm_castsi128_ps(x), _mm_castsi128_ps(y)));
+    else if constexpr (std::is_same<T, double>::value)
+        return _mm_castpd_si128(_mm_cmpeq_pd(_mm_castsi128_pd(x), _mm_castsi128_pd(y)));
+    else if constexpr (sizeof(T) == 1)
+        return _mm_cmpeq_epi8(x, y);
+    else if constexpr (sizeof(T) == 2)
+        return _mm_cmpeq_epi16(x, y);
+    else if constexpr (sizeof(T) == 4)
+        return _mm_cmpeq_epi32(x, y);
+    else {  // SSE2 has no 64-bit compare, both halves must match
+        __m128i halves = _mm_cmpeq_epi32(x, y);
+        return _mm_and_si128(halves, _mm_shuffle_epi32(halves, _MM_SHUFFLE(2, 3, 0, 1)));
+    }
+}
+
+template <class T>
+__m128i load( const T* p ) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+}
+
+template <class T>
+size_t mismatch_sse2( const T* a, const T* b, size_t n ) {
+    constexpr size_t lanes = 16 / sizeof(T);
+    size_t i = 0;
+    for (; i + 4 * lanes <= n; i += 4 * lanes) {    // Check 4 blocks at once, find the lane only on a miss
+        __m128i same = equal_lanes<T>(load(a + i), load(b + i));
+        for (size_t k = lanes; k < 4 * lanes; k += lanes)
+            same = _mm_and_si128(same, equal_lanes<T>(load(a + i + k), load(b + i + k)));
+        if (_mm_movemask_epi8(same) != 0xFFFF)
+            break;
+    }
+    for (; i + lanes <= n; i += lanes)
+        if (unsigned diff = ~unsigned(_mm_movemask_epi8(equal_lanes<T>(load(a + i), load(b + i)))) & 0xFFFF)
+            return i + first_bit(diff) / sizeof(T);
+    return i + mismatch_scalar(a + i, b + i, n - i);
+}
+
+// Byte mask of the lanes of 16 bytes at *p* which equal any of the splats
+template <class T, size_t Count>
+unsigned match_mask( const T* p, const __m128i (&splats)[Count] ) {
+    __m128i x = load(p), hits = _mm_setzero_si128();
+    for (size_t k = 0; k < Count; ++k)
+        hits = _mm_or_si128(hits, equal_lanes<T>(x, splats[k]));
+    return unsigned(_mm_movemask_epi8(hits));
+}
+
+template <class T, size_t Count>
+size_t find_sse2( const T* p, size_t n, const T* values ) {
+    constexpr size_t lanes = 16 / sizeof(T);
+    __m128i splats[Count];
+    for (size_t k = 0; k < Count; ++k)
+        splats[k] = splat(values[k]);
+    size_t i = 0;
+    if constexpr (Count == 1) {     // Check 4 blocks at once, find the element only on a hit
+        __m128i v = splats[0];
+        for (; i + 4 * lanes <= n; i += 4 * lanes) {
+            __m128i hits = _mm_or_si128(_mm_or_si128(equal_lanes<T>(load(p + i), v), equal_lanes<T>(load(p + i + lanes), v)),
+                                        _mm_or_si128(equal_lanes<T>(load(p + i + 2 * lanes), v), equal_lanes<T>(load(p + i + 3 * lanes), v)));
+            if (_mm_movemask_epi8(hits))
+                break;
+        }
+    }
+    for (; i + lanes <= n; i += lanes)
+        if (unsigned mask = match_mask(p + i, splats))
+            return i + first_bit(mask) / sizeof(T);
+    return i + find_scalar<T, Count>(p + i, n - i, values);
+}
+
+// Matching lanes are counted bytewise in 8-bit counters, which are summed up
+// before they overflow; SSE2 has no popcount instruction
+template <class T>
+size_t count_sse2( const T* p, size_t n, T value ) {
+    constexpr size_t lanes = 16 / sizeof(T);
+    __m128i v = splat(value), total = _mm_setzero_si128();
+    size_t i = 0;
+    while (i + lanes <= n) {
+        __m128i counters = _mm_setzero_si128();
+        for (int round = 0; round < 255 && i + lanes <= n; ++round, i += lanes)
+            counters = _mm_sub_epi8(counters, equal_lanes<T>(load(p + i), v));
+        total = _mm_add_epi64(total, _mm_sad_epu8(counters, _mm_setzero_si128()));
+    }
+    uint64_t sums[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(sums), total);
+    return size_t(sums[0] + sums[1]) / sizeof(T) + count_scalar(p + i, n - i, value);
+}
+#endif
+
+#if defined(SIMD_AVX2)
+template <class T>
+SIMD_AVX2 __m256i splat256( T value ) {
+    lane_bits<T> bits = bits_of(value);
+    if constexpr (sizeof(T) == 1)
+        return _mm256_set1_epi8(char(bits));
+    else if constexpr (sizeof(T) == 2)
+        return _mm256_set1_epi16(short(bits));
+    else if constexpr (sizeof(T) == 4)
+        return _mm256_set1_epi32(int(bits));
+    else return _mm256_set1_epi64x((long long)bits);
+}
+
+template <class T>
+SIMD_AVX2 __m256i equal_lanes256( __m256i x, __m256i y ) {
+    if constexpr (std::is_same<T, float>::value)
+        return _mm256_castps_si256(_mm256_cmp_ps(_mm256_castsi256_ps(x), _mm256_castsi256_ps(y), _CMP_EQ_OQ));
+    else if constexpr (std::is_same<T, double>::value)
+        return _mm256_castpd_si256(_mm256_cmp_pd(_mm256_castsi256_pd(x), _mm256_castsi256_pd(y), _CMP_EQ_OQ));
+    else if constexpr (sizeof(T) == 1)
+        return _mm256_cmpeq_epi8(x, y);
+    else if constexpr (sizeof(T) == 2)
+        return _mm256_cmpeq_epi16(x, y);
+    else if constexpr (sizeof(T) == 4)
+        return _mm256_cmpeq_epi32(x, y);
+    else return _mm256_cmpeq_epi64(x, y);
+}
+
+template <class T>
+SIMD_AVX2 __m256i load256( const T* p ) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+}
+
+template <class T>
+SIMD_AVX2 size_t mismatch_avx2( const T* a, const T* b, size_t n ) {
+    constexpr size_t lanes = 32 / sizeof(T);
+    size_t i = 0;
+    for (; i + 2 * lanes <= n; i += 2 * lanes)
+        if (unsigned(_mm256_movemask_epi8(_mm256_and_si256(equal_lanes256<T>(load256(a + i), load256(b + i)),
+                equal_lanes256<T>(load256(a + i + lanes), load256(b + i + lanes))))) != 0xFFFFFFFF)
+            break;
+    for (; i + lanes <= n; i += lanes)
+        if (unsigned diff = ~unsigned(_mm256_movemask_epi8(equal_lanes256<T>(load256(a + i), load256(b + i)))))
+            return i + first_bit(diff) / sizeof(T);
+    return i + mismatch_scalar(a + i, b + i, n - i);
+}
+
+template <class T, size_t Count>
+SIMD_AVX2 unsigned match_mask256( const T* p, const __m256i (&splats)[Count] ) {
+    __m256i x = load256(p), hits = _mm256_setzero_si256();
+    for (size_t k = 0; k < Count; ++k)
+        hits = _mm256_or_si256(hits, equal_lanes256<T>(x, splats[k]));
+    return unsigned(_mm256_movemask_epi8(hits));
+}
+
+template <class T, size_t Count>
+SIMD_AVX2 size_t find_avx2( const T* p, size_t n, const T* values ) {
+    constexpr size_t lanes = 32 / sizeof(T);
+    __m256i splats[Count];
+    for (size_t k = 0; k < Count; ++k)
+        splats[k] = splat256(values[k]);
+    size_t i = 0;
+    if constexpr (Count == 1) {
+        __m256i v = splats[0];
+        for (; i + 2 * lanes <= n; i += 2 * lanes)
+            if (_mm256_movemask_epi8(_mm256_or_si256(equal_lanes256<T>(load256(p + i), v), equal_lanes256<T>(load256(p + i + lanes), v))))
+                break;
+    }
+    for (; i + lanes <= n; i += lanes)
+        if (unsigned mask = match_mask256(p + i, splats))
+            return i + first_bit(mask) / sizeof(T);
+    return i + find_scalar<T, Count>(p + i, n - i, values);
+}
+
+template <class T>
+SIMD_AVX2 size_t count_avx2( const T* p, size_t n, T value ) {
+    constexpr size_t lanes = 32 / sizeof(T);
+    __m256i v = splat256(value);
+    size_t i = 0, bytes = 0;
+    for (; i + lanes <= n; i += lanes)
+        bytes += bit_count(unsigned(_mm256_movemask_epi8(equal_lanes256<T>(load256(p + i), v))));
+    return bytes / sizeof(T) + count_scalar(p + i, n - i, value);
+}
+#endif
+
+#if defined(SIMD_AVX512)
+template <class T>
+SIMD_AVX512 __m512i splat512( T value ) {
+    lane_bits<T> bits = bits_of(value);
+    if constexpr (sizeof(T) == 1)
+        return _mm512_set1_epi8(char(bits));
+    else if constexpr (sizeof(T) == 2)
+        return _mm512_set1_epi16(short(bits));
+    else if constexpr (sizeof(T) == 4)
+        return _mm512_set1_epi32(int(bits));
+    else return _mm512_set1_epi64((long long)bits);
+}
+
+// Bit mask of the lanes of x and y which are equal as T, one bit per lane
+template <class T>
+SIMD_AVX512 unsigned long long equal_mask512( __m512i x, __m512i y ) {
+    if constexpr (std::is_same<T, float>::value)
+        return _mm512_cmp_ps_mask(_mm512_castsi512_ps(x), _mm512_castsi512_ps(y), _CMP_EQ_OQ);
+    else if constexpr (std::is_same<T, double>::value)
+        return _mm512_cmp_pd_mask(_mm512_castsi512_pd(x), _mm512_castsi512_pd(y), _CMP_EQ_OQ);
+    else if constexpr (sizeof(T) == 1)
+        return _mm512_cmpeq_epi8_mask(x, y);
+    else if constexpr (sizeof(T) == 2)
+        return _mm512_cmpeq_epi16_mask(x, y);
+    else if constexpr (sizeof(T) == 4)
+        return _mm512_cmpeq_epi32_mask(x, y);
+    else return _mm512_cmpeq_epi64_mask(x, y);
+}
+
+template <class T>
+SIMD_AVX512 __m512i load512( const T* p ) {
+    return _mm512_loadu_si512(static_cast<const void*>(p));
+}
+
+template <class T>
+SIMD_AVX512 size_t mismatch_avx512( const T* a, const T* b, size_t n ) {
+    constexpr size_t lanes = 64 / sizeof(T);
+    constexpr unsigned long long all = lanes == 64 ? ~0ull : (1ull << lanes) - 1;
+    size_t i = 0;
+    for (; i + lanes <= n; i += lanes)
+        if (unsigned long long diff = ~equal_mask512<T>(load512(a + i), load512(b + i)) & all)
+            return i + first_bit(diff);
+    return i + mismatch_scalar(a + i, b + i, n - i);
+}
+
+template <class T, size_t Count>
+SIMD_AVX512 size_t find_avx512( const T* p, size_t n, const T* values ) {
+    constexpr size_t lanes = 64 / sizeof(T);
+    __m512i splats[Count];
+    for (size_t k = 0; k < Count; ++k)
+        splats[k] = splat512(values[k]);
+    size_t i = 0;
+    for (; i + lanes <= n; i += lanes) {
+        __m512i x = load512(p + i);
+        unsigned long long hits = 0;
+        for (size_t k = 0; k < Count; ++k)
+            hits |= equal_mask512<T>(x, splats[k]);
+        if (hits)
+            return i + first_bit(hits);
+    }
+    return i + find_scalar<T, Count>(p + i, n - i, values);
+}
+
+template <class T>
+SIMD_AVX512 size_t count_avx512( const T* p, size_t n, T value ) {
+    constexpr size_t lanes = 64 / sizeof(T);
+    __m512i v = splat512(value);
+    size_t i = 0, result = 0;
+    for (; i + lanes <= n; i += lanes)
+        result += bit_count(equal_mask512<T>(load512(p + i), v));
+    return result + count_scalar(p + i, n - i, value);
+}
+#endif
+
+// Index of the first pair of elements of [a, a + n) and [b, b + n) which
+// don't compare equal (for floats -0 equals 0, NaN equals nothing), or n
+template <class T>
+size_t mismatch( const T* a, const T* b, size_t n ) {
+    static_assert(is_searchable<T>::value, "simd::mismatch: T does not fit SIMD lanes");
+    static const dispatch_table<size_t (*)(const T*, const T*, size_t)> table(
+        mismatch_scalar<T>, SIMD_IF_SSE2(mismatch_sse2<T>), SIMD_IF_AVX2(mismatch_avx2<T>), SIMD_IF_AVX512(mismatch_avx512<T>));
+    return table()(a, b, n);
+}
+
+// Offset of the first differing byte of the blocks at a and b, or *bytes* if they are equal
+inline size_t mismatch_bytes( const void* a, const void* b, size_t bytes ) {
+    return mismatch(static_cast<const unsigned char*>(a), static_cast<const unsigned char*>(b), bytes);
+}
+
+// Index of the first element of [p, p + n) equal to any of [values, values + count), or n
+template <class T>
+size_t find_any_of( const T* p, size_t n, const T* values, size_t count ) {
+    static_assert(is_searchable<T>::value, "simd::find_any_of: T does not fit SIMD lanes");
+    // Search for *max_values* values at a time, each group only before the earliest hit yet
+    for (size_t k = 0; k < count; k += max_values)
+        n = with_count(std::min(count - k, max_values), [&](auto c) {
+            static const dispatch_table<size_t (*)(const T*, size_t, const T*)> table(
+                find_scalar<T, c.value>, SIMD_IF_SSE2((find_sse2<T, c.value>)),
+                SIMD_IF_AVX2((find_avx2<T, c.value>)), SIMD_IF_AVX512((find_avx512<T, c.value>)));
+            return table()(p, n, values + k);
+        });
+    return n;
+}
+
+// Index of the first element of [p, p + n) equal to *value*, or n
+template <class T>
+size_t find( const T* p, size_t n, T value ) {
+    return find_any_of(p, n, &value, 1);
+}
+
+// Number of elements of [p, p + n) equal to *value*
+template <class T>
+size_t count( const T* p, size_t n, T value ) {
+    static_assert(is_searchable<T>::value, "simd::count: T does not fit SIMD lanes");
+    static const dispatch_table<size_t (*)(const T*, size_t, T)> table(
+        count_scalar<T>, SIMD_IF_SSE2(count_sse2<T>), SIMD_IF_AVX2(count_avx2<T>), SIMD_IF_AVX512(count_avx512<T>));
+    return table()(p, n, value);
+}
+
+}
@@ -0,0 +1,565 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include "simd.hpp"
+
+// Reductions over arrays of numbers: sums, dot products and extremes.
+// float, double and int32_t have SSE2 / AVX2 / AVX-512 kernels, chosen
+// like the search kernels; other arithmetic types use the scalar ones
+namespace simd {
+
+// How floating point numbers are summed up:
+//   fast     - many partial sums at once, as fast as memory allows
+//   pairwise - fast sums of short blocks added up pairwise, the error grows with log(n)
+//   kahan    - compensated summation, the error doesn't grow with n, but it's slower
+enum class summation { fast, pairwise, kahan };
+
+// Type sums of T are returned in: integers are widened to 64 bits
+template <class T>
+struct sum_type {
+    typedef typename std::conditional<!std::is_integral<T>::value, T,
+            typename std::conditional<std::is_signed<T>::value, long long, unsigned long long>::type>::type type;
+};
+
+template <class T>
+using sum_t = typename sum_type<T>::type;
+
+// Tells whether T has vectorized reduction kernels
+template <class T>
+struct is_reducible : std::integral_constant<bool,
+    std::is_same<T, float>::value || std::is_same<T, double>::value || std::is_same<T, int32_t>::value> {};
+
+// Scalar kernels with four independent partial results, so that
+// consecutive additions don't wait for each other
+
+template <class T>
+sum_t<T> sum_scalar( const T* p, size_t n ) {
+    sum_t<T> acc[4] = {};
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+        for (size_t k = 0; k < 4; ++k)
+            acc[k] += p[i + k];
+    for (; i < n; ++i)
+        acc[0] += p[i];
+    return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+}
+
+template <class T>
+sum_t<T> dot_scalar( const T* a, const T* b, size_t n ) {
+    sum_t<T> acc[4] = {};
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+        for (size_t k = 0; k < 4; ++k)
+            acc[k] += sum_t<T>(a[i + k]) * b[i + k];
+    for (; i < n; ++i)
+        acc[0] += sum_t<T>(a[i]) * b[i];
+    return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+}
+
+// Smallest and largest of n >= 1 elements
+template <class T>
+std::pair<T, T> minmax_scalar( const T* p, size_t n ) {
+    T lo = p[0], hi = p[0];
+    for (size_t i = 1; i < n; ++i) {
+        lo = p[i] < lo ? p[i] : lo;
+        hi = hi < p[i] ? p[i] : hi;
+    }
+    return { lo, hi };
+}
+
+// Kahan summation in four lanes: each lane keeps the low order bits its
+// last addition lost and subtracts them from the next number
+template <class T>
+T sum_kahan( const T* p, size_t n ) {
+    T sum[4] = {}, lost[4] = {};
+    auto add = [&](size_t k, T x) {
+        T y = x - lost[k], t = sum[k] + y;
+        lost[k] = (t - sum[k]) - y;
+        sum[k] = t;
+    };
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+        for (size_t k = 0; k < 4; ++k)
+            add(k, p[i + k]);
+    for (; i < n; ++i)
+        add(0, p[i]);
+    for (size_t k = 1; k < 4; ++k) {
+        add(0, -lost[k]);
+        add(0, sum[k]);
+    }
+    return sum[0];
+}
+
+#if defined(SIMD_SSE2)
+// Operations on SIMD vectors of T, the same for each instruction set, so
+// that the kernels below have the same shape for each of them. Floating
+// point ones also have the element-wise operations and comparisons that
+// expression.hpp builds its kernels from; a *mask* holds the comparison results
+template <class T>
+struct sse2_ops;
+
+template <>
+struct sse2_ops<float> {
+    typedef __m128 type;
+    static type load( const float* p ) { return _mm_loadu_ps(p); }
+    static type splat( float x ) { return _mm_set1_ps(x); }
+    static type add( type a, type b ) { return _mm_add_ps(a, b); }
+    static type mul( type a, type b ) { return _mm_mul_ps(a, b); }
+    static type min( type a, type b ) { return _mm_min_ps(a, b); }
+    static type max( type a, type b ) { return _mm_max_ps(a, b); }
+    static void store( float* p, type a ) { _mm_storeu_ps(p, a); }
+    static type sub( type a, type b ) { return _mm_sub_ps(a, b); }
+    static type div( type a, type b ) { return _mm_div_ps(a, b); }
+    static type sqrt( type a ) { return _mm_sqrt_ps(a); }
+    static type abs( type a ) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+    static type neg( type a ) { return _mm_xor_ps(a, _mm_set1_ps(-0.0f)); }
+    typedef type mask;
+    static mask less( type a, type b ) { return _mm_cmplt_ps(a, b); }
+    static mask less_equal( type a, type b ) { return _mm_cmple_ps(a, b); }
+    static mask equal( type a, type b ) { return _mm_cmpeq_ps(a, b); }
+    static mask not_equal( type a, type b ) { return _mm_cmpneq_ps(a, b); }
+    static mask both( mask a, mask b ) { return _mm_and_ps(a, b); }
+    static mask either( mask a, mask b ) { return _mm_or_ps(a, b); }
+    static mask invert( mask a ) { return _mm_xor_ps(a, _mm_castsi128_ps(_mm_set1_epi32(-1))); }
+    static type select( mask m, type a, type b ) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+};
+
+template <>
+struct sse2_ops<double> {
+    typedef __m128d type;
+    static type load( const double* p ) { return _mm_loadu_pd(p); }
+    static type splat( double x ) { return _mm_set1_pd(x); }
+    static type add( type a, type b ) { return _mm_add_pd(a, b); }
+    static type mul( type a, type b ) { return _mm_mul_pd(a, b); }
+    static type min( type a, type b ) { return _mm_min_pd(a, b); }
+    static type max( type a, type b ) { return _mm_max_pd(a, b); }
+    static void store( double* p, type a ) { _mm_storeu_pd(p, a); }
+    static type sub( type a, type b ) { return _mm_sub_pd(a, b); }
+    static type div( type a, type b ) { return _mm_div_pd(a, b); }
+    static type sqrt( type a ) { return _mm_sqrt_pd(a); }
+    static type abs( type a ) { return _mm_andnot_pd(_mm_set1_pd(-0.0), a); }
+    static type neg( type a ) { return _mm_xor_pd(a, _mm_set1_pd(-0.0)); }
+    typedef type mask;
+    static mask less( type a, type b ) { return _mm_cmplt_pd(a, b); }
+    static mask less_equal( type a, type b ) { return _mm_cmple_pd(a, b); }
+    static mask equal( type a, type b ) { return _mm_cmpeq_pd(a, b); }
+    static mask not_equal( type a, type b ) { return _mm_cmpneq_pd(a, b); }
+    static mask both( mask a, mask b ) { return _mm_and_pd(a, b); }
+    static mask either( mask a, mask b ) { return _mm_or_pd(a, b); }
+    static mask invert( mask a ) { return _mm_xor_pd(a, _mm_castsi128_pd(_mm_set1_epi32(-1))); }
+    static type select( mask m, type a, type b ) { return _mm_or_pd(_mm_and_pd(m, a), _mm_andnot_pd(m, b)); }
+};
+
+template <>
+struct sse2_ops<int32_t> {
+    typedef __m128i type;
+    static type load( const int32_t* p ) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+    static type splat( int32_t x ) { return _mm_set1_epi32(x); }
+    static type min( type a, type b ) {     // SSE2 has no 32-bit min / max
+        __m128i greater = _mm_cmpgt_epi32(a, b);
+        return _mm_or_si128(_mm_and_si128(greater, b), _mm_andnot_si128(greater, a));
+    }
+    static type max( type a, type b ) {
+        __m128i greater = _mm_cmpgt_epi32(a, b);
+        return _mm_or_si128(_mm_and_si128(greater, a), _mm_andnot_si128(greater, b));
+    }
+    static void store( int32_t* p, type a ) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), a); }
+};
+
+template <class T>
+T sum_sse2( const T* p, size_t n ) {
+    typedef sse2_ops<T> ops;
+    constexpr size_t lanes = 16 / sizeof(T);
+    typename ops::type acc[4] = { ops::splat(0), ops::splat(0), ops::splat(0), ops::splat(0) };
+    size_t i = 0;
+    for (; i + 4 * lanes <= n; i += 4 * lanes)
+        for (size_t k = 0; k < 4; ++k)
+            acc[k] = ops::add(acc[k], ops::load(p + i + k * lanes));
+    T parts[lanes];
+    ops::store(parts, ops::add(ops::add(acc[0], acc[1]), ops::add(acc[2], acc[3])));
+    return sum_scalar(parts, lanes) + sum_scalar(p + i, n - i);
+}
+
+template <class T>
+T dot_sse2( const T* a, const T* b, size_t n ) {
+    typedef sse2_ops<T> ops;
+    constexpr size_t lanes = 16 / sizeof(T);
+    typename ops::type acc[4] = { ops::splat(0), ops::splat(0), ops::splat(0), ops::splat(0) };
+    size_t i = 0;
+    for (; i + 4 * lanes <= n; i += 4 * lanes)
+        for (size_t k = 0; k < 4; ++k)
+            acc[k] = ops::add(acc[k], ops::mul(ops::load(a + i + k * lanes), ops::load(b + i + k * lanes)));
+    T parts[lanes];
+    ops::store(parts, ops::add(ops::add(acc[0], acc[1]), ops::add(acc[2], acc[3])));
+    return sum_scalar(parts, lanes) + dot_scalar(a + i, b + i, n - i);
+}
+
+template <class T>
+std::pair<T, T> minmax_sse2( const T* p, size_t n ) {
+    typedef sse2_ops<T> ops;
+    constexpr size_t lanes = 16 / sizeof(T);
+    if (n < 2 * lanes)
+        return minmax_scalar(p, n);
+    typename ops::type lo[2] = { ops::splat(p[0]), ops::splat(p[0]) }, hi[2] = { lo[0], lo[0] };
+    size_t i = 0;
+    for (; i + 2 * lanes <= n; i += 2 * lanes)
+        for (size_t k = 0; k < 2; ++k) {
+            typename ops::type x = ops::load(p + i + k * lanes);
+            lo[k] = ops::min(lo[k], x);
+            hi[k] = ops::max(hi[k], x);
+        }
+    T low[lanes], high[lanes];
+    ops::store(low, ops::min(lo[0], lo[1]));
+    ops::store(high, ops::max(hi[0], hi[1]));
+    std::pair<T, T> result(minmax_scalar(low, lanes).first, minmax_scalar(high, lanes).second);
+    if (i < n) {
+        std::pair<T, T> rest = minmax_scalar(p + i, n - i);
+        result.first = rest.first < result.first ? rest.first : result.first;
+        result.second = result.second < rest.second ? rest.second : result.second;
+    }
+    return result;
+}
+
+// int32_t sums are widened to 64 bits: the sign is copied to the upper halves
+inline long long sum_int32_sse2( const int32_t* p, size_t n ) {
+    __m128i acc[2] = { _mm_setzero_si128(), _mm_setzero_si128() };
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        __m128i sign = _mm_cmpgt_epi32(_mm_setzero_si128(), x);
+        acc[0] = _mm_add_epi64(acc[0], _mm_unpacklo_epi32(x, sign));
+        acc[1] = _mm_add_epi64(acc[1], _mm_unpackhi_epi32(x, sign));
+    }
+    long long parts[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(parts), _mm_add_epi64(acc[0], acc[1]));
+    return parts[0] + parts[1] + sum_scalar(p + i, n - i);
+}
+#endif
+
+#if defined(SIMD_AVX2)
+template <class T>
+struct avx2_ops;
+
+template <>
+struct avx2_ops<float> {
+    typedef __m256 type;
+    SIMD_AVX2 static type load( const float* p ) { return _mm256_loadu_ps(p); }
+    SIMD_AVX2 static type splat( float x ) { return _mm256_set1_ps(x); }
+    SIMD_AVX2 static type add( type a, type b ) { return _mm256_add_ps(a, b); }
+    SIMD_AVX2 static type mul( type a, type b ) { return _mm256_mul_ps(a, b); }
+    SIMD_AVX2 static type min( type a, type b ) { return _mm256_min_ps(a, b); }
+    SIMD_AVX2 static type max( type a, type b ) { return _mm256_max_ps(a, b); }
+    SIMD_AVX2 static void store( float* p, type a ) { _mm256_storeu_ps(p, a); }
+    SIMD_AVX2 static type sub( type a, type b ) { return _mm256_sub_ps(a, b); }
+    SIMD_AVX2 static type div( type a, type b ) { return _mm256_div_ps(a, b); }
+    SIMD_AVX2 static type sqrt( type a ) { return _mm256_sqrt_ps(a); }
+    SIMD_AVX2 static type abs( type a ) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+    SIMD_AVX2 static type neg( type a ) { return _mm256_xor_ps(a, _mm256_set1_ps(-0.0f)); }
+    typedef type mask;
+    SIMD_AVX2 static mask less( type a, type b ) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+    SIMD_AVX2 static mask less_equal( type a, type b ) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+    SIMD_AVX2 static mask equal( type a, type b ) { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+    SIMD_AVX2 static mask not_equal( type a, type b ) { return _mm256_cmp_ps(a, b, _CMP_NEQ_UQ); }
+    SIMD_AVX2 static mask both( mask a, mask b ) { return _mm256_and_ps(a, b); }
+    SIMD_AVX2 static mask either( mask a, mask b ) { return _mm256_or_ps(a, b); }
+    SIMD_AVX2 static mask invert( mask a ) { return _mm256_xor_ps(a, _mm256_castsi256_ps(_mm256_set1_epi32(-1))); }
+    SIMD_AVX2 static type select( mask m, type a, type b ) { return _mm256_blendv_ps(b, a, m); }
+};
+
+template <>
+struct avx2_ops<double> {
+    typedef __m256d type;
+    SIMD_AVX2 static type load( const double* p ) { return _mm256_loadu_pd(p); }
+    SIMD_AVX2 static type splat( double x ) { return _mm256_set1_pd(x); }
+    SIMD_AVX2 static type add( type a, type b ) { return _mm256_add_pd(a, b); }
+    SIMD_AVX2 static type mul( type a, type b ) { return _mm256_mul_pd(a, b); }
+    SIMD_AVX2 static type min( type a, type b ) { return _mm256_min_pd(a, b); }
+    SIMD_AVX2 static type max( type a, type b ) { return _mm256_max_pd(a, b); }
+    SIMD_AVX2 static void store( double* p, type a ) { _mm256_storeu_pd(p, a); }
+    SIMD_AVX2 static type sub( type a, type b ) { return _mm256_sub_pd(a, b); }
+    SIMD_AVX2 static type div( type a, type b ) { return _mm256_div_pd(a, b); }
+    SIMD_AVX2 static type sqrt( type a ) { return _mm256_sqrt_pd(a); }
+    SIMD_AVX2 static type abs( type a ) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a); }
+    SIMD_AVX2 static type neg( type a ) { return _mm256_xor_pd(a, _mm256_set1_pd(-0.0)); }
+    typedef type mask;
+    SIMD_AVX2 static mask less( type a, type b ) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+    SIMD_AVX2 static mask less_equal( type a, type b ) { return _mm256_cmp_pd(a, b, _CMP_LE_OQ); }
+    SIMD_AVX2 static mask equal( type a, type b ) { return _mm256_cmp_pd(a, b, _CMP_EQ_OQ); }
+    SIMD_AVX2 static mask not_equal( type a, type b ) { return _mm256_cmp_pd(a, b, _CMP_NEQ_UQ); }
+    SIMD_AVX2 static mask both( mask a, mask b ) { return _mm256_and_pd(a, b); }
+    SIMD_AVX2 static mask either( mask a, mask b ) { return _mm256_or_pd(a, b); }
+    SIMD_AVX2 static mask invert( mask a ) { return _mm256_xor_pd(a, _mm256_castsi256_pd(_mm256_set1_epi32(-1))); }
+    SIMD_AVX2 static type select( mask m, type a, type b ) { return _mm256_blendv_pd(b, a, m); }
+};
+
+template <>
+struct avx2_ops<int32_t> {
+    typedef __m256i type;
+    SIMD_AVX2 static type load( const int32_t* p ) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+    SIMD_AVX2 static type splat( int32_t x ) { return _mm256_set1_epi32(x); }
+    SIMD_AVX2 static type min( type a, type b ) { return _mm256_min_epi32(a, b); }
+    SIMD_AVX2 static type max( type a, type b ) { return _mm256_max_epi32(a, b); }
+    SIMD_AVX2 static void store( int32_t* p, type a ) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), a); }
+};
+
+template <class T>
+SIMD_AVX2 T sum_avx2( const T* p, size_t n ) {
+    typedef avx2_ops<T> ops;
+    constexpr size_t lanes = 32 / sizeof(T);
+    typename ops::type acc[4] = { ops::splat(0), ops::splat(0), ops::splat(0), ops::splat(0) };
+    size_t i = 0;
+    for (; i + 4 * lanes <= n; i += 4 * lanes)
+        for (size_t k = 0; k < 4; ++k)
+            acc[k] = ops::add(acc[k], ops::load(p + i + k * lanes));
+    T parts[lanes];
+    ops::store(parts, ops::add(ops::add(acc[0], acc[1]), ops::add(acc[2], acc[3])));
+    return sum_scalar(parts, lanes) + sum_scalar(p + i, n - i);
+}
+
+template <class T>
+SIMD_AVX2 T dot_avx2( const T* a, const T* b, size_t n ) {
+    typedef avx2_ops<T> ops;
+    constexpr size_t lanes = 32 / sizeof(T);
+    typename ops::type acc[4] = { ops::splat(0), ops::splat(0), ops::splat(0), ops::splat(0) };
+    size_t i = 0;
+    for (; i + 4 * lanes <= n; i += 4 * lanes)
+        for (size_t k = 0; k < 4; ++k)
+            acc[k] = ops::add(acc[k], ops::mul(ops::load(a + i + k * lanes), ops::load(b + i + k * lanes)));
+    T parts[lanes];
+    ops::store(parts, ops::add(ops::add(acc[0], acc[1]), ops::add(acc[2], acc[3])));
+    return sum_scalar(parts, lanes) + dot_scalar(a + i, b + i, n - i);
+}
+
+template <class T>
+SIMD_AVX2 std::pair<T, T> minmax_avx2( const T* p, size_t n ) {
+    typedef avx2_ops<T> ops;
+    constexpr size_t lanes = 32 / sizeof(T);
+    if (n < 2 * lanes)
+        return minmax_scalar(p, n);
+    typename ops::type lo[2] = { ops::splat(p[0]), ops::splat(p[0]) }, hi[2] = { lo[0], lo[0] };
+    size_t i = 0;
+    for (; i + 2 * lanes <= n; i += 2 * lanes)
+        for (size_t k = 0; k < 2; ++k) {
+            typename ops::type x = ops::load(p + i + k * lanes);
+            lo[k] = ops::min(lo[k], x);
+            hi[k] = ops::max(hi[k], x);
+        }
+    T low[lanes], high[lanes];
+    ops::store(low, ops::min(lo[0], lo[1]));
+    ops::store(high, ops::max(hi[0], hi[1]));
+    std::pair<T, T> result(minmax_scalar(low, lanes).first, minmax_scalar(high, lanes).second);
+    if (i < n) {
+        std::pair<T, T> rest = minmax_scalar(p + i, n - i);
+        result.first = rest.first < result.first ? rest.first : result.first;
+        result.second = result.second < rest.second ? rest.second : result.second;
+    }
+    return result;
+}
+
+SIMD_AVX2 inline long long sum_int32_avx2( const int32_t* p, size_t n ) {
+    __m256i acc[2] = { _mm256_setzero_si256(), _mm256_setzero_si256() };
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+        for (size_t k = 0; k < 2; ++k)
+            acc[k] = _mm256_add_epi64(acc[k], _mm256_cvtepi32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i + 4 * k))));
+    long long parts[4];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(parts), _mm256_add_epi64(acc[0], acc[1]));
+    return sum_scalar(parts, 4) + sum_scalar(p + i, n - i);
+}
+#endif
+
+#if defined(SIMD_AVX512)
+template <class T>
+struct avx512_ops;
+
+// min / max, sqrt and the widening below use the masked intrinsics, whose plain forms
+// trip -Wmaybe-uninitialized in GCC 12
+template <>
+struct avx512_ops<float> {
+    typedef __m512 type;
+    SIMD_AVX512 static type load( const float* p ) { return _mm512_loadu_ps(p); }
+    SIMD_AVX512 static type splat( float x ) { return _mm512_set1_ps(x); }
+    SIMD_AVX512 static type add( type a, type b ) { return _mm512_add_ps(a, b); }
+    SIMD_AVX512 static type mul( type a, type b ) { return _mm512_mul_ps(a, b); }
+    SIMD_AVX512 static type min( type a, type b ) { return _mm512_mask_min_ps(a, 0xFFFF, a, b); }
+    SIMD_AVX512 static type max( type a, type b ) { return _mm512_mask_max_ps(a, 0xFFFF, a, b); }
+    SIMD_AVX512 static void store( float* p, type a ) { _mm512_storeu_ps(p, a); }
+    SIMD_AVX512 static type sub( type a, type b ) { return _mm512_sub_ps(a, b); }
+    SIMD_AVX512 static type div( type a, type b ) { return _mm512_div_ps(a, b); }
+    SIMD_AVX512 static type sqrt( type a ) { return _mm512_mask_sqrt_ps(a, 0xFFFF, a); }
+    SIMD_AVX512 static type abs( type a ) { return _mm512_abs_ps(a); }
+    SIMD_AVX512 static type neg( type a ) { return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(a), _mm512_set1_epi32(INT32_MIN))); }
+    typedef __mmask16 mask;
+    SIMD_AVX512 static mask less( type a, type b ) { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+    SIMD_AVX512 static mask less_equal( type a, type b ) { return _mm512_cmp_ps_mask(a, b, _CMP_LE_OQ); }
+    SIMD_AVX512 static mask equal( type a, type b ) { return _mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ); }
+    SIMD_AVX512 static mask not_equal( type a, type b ) { return _mm512_cmp_ps_mask(a, b, _CMP_NEQ_UQ); }
+    SIMD_AVX512 static mask both( mask a, mask b ) { return mask(a & b); }
+    SIMD_AVX512 static mask either( mask a, mask b ) { return mask(a | b); }
+    SIMD_AVX512 static mask invert( mask a ) { return mask(~a); }
+    SIMD_AVX512 static type select( mask m, type a, type b ) { return _mm512_mask_blend_ps(m, b, a); }
+};
+
+template <>
+struct avx512_ops<double> {
+    typedef __m512d type;
+    SIMD_AVX512 static type load( const double* p ) { return _mm512_loadu_pd(p); }
+    SIMD_AVX512 static type splat( double x ) { return _mm512_set1_pd(x); }
+    SIMD_AVX512 static type add( type a, type b ) { return _mm512_add_pd(a, b); }
+    SIMD_AVX512 static type mul( type a, type b ) { return _mm512_mul_pd(a, b); }
+    SIMD_AVX512 static type min( type a, type b ) { return _mm512_mask_min_pd(a, 0xFF, a, b); }
+    SIMD_AVX512 static type max( type a, type b ) { return _mm512_mask_max_pd(a, 0xFF, a, b); }
+    SIMD_AVX512 static void store( double* p, type a ) { _mm512_storeu_pd(p, a); }
+    SIMD_AVX512 static type sub( type a, type b ) { return _mm512_sub_pd(a, b); }
+    SIMD_AVX512 static type div( type a, type b ) { return _mm512_div_pd(a, b); }
+    SIMD_AVX512 static type sqrt( type a ) { return _mm512_mask_sqrt_pd(a, 0xFF, a); }
+    SIMD_AVX512 static type abs( type a ) { return _mm512_abs_pd(a); }
+    SIMD_AVX512 static type neg( type a ) { return _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(a), _mm512_set1_epi64(INT64_MIN))); }
+    typedef __mmask8 mask;
+    SIMD_AVX512 static mask less( type a, type b ) { return _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ); }
+    SIMD_AVX512 static mask less_equal( type a, type b ) { return _mm512_cmp_pd_mask(a, b, _CMP_LE_OQ); }
+    SIMD_AVX512 static mask equal( type a, type b ) { return _mm512_cmp_pd_mask(a, b, _CMP_EQ_OQ); }
+    SIMD_AVX512 static mask not_equal( type a, type b ) { return _mm512_cmp_pd_mask(a, b, _CMP_NEQ_UQ); }
+    SIMD_AVX512 static mask both( mask a, mask b ) { return mask(a & b); }
+    SIMD_AVX512 static mask either( mask a, mask b ) { return mask(a | b); }
+    SIMD_AVX512 static mask invert( mask a ) { return mask(~a); }
+    SIMD_AVX512 static type select( mask m, type a, type b ) { return _mm512_mask_blend_pd(m, b, a); }
+};
+
+template <>
+struct avx512_ops<int32_t> {
+    typedef __m512i type;
+    SIMD_AVX512 static type load( const int32_t* p ) { return _mm512_loadu_si512(static_cast<const void*>(p)); }
+    SIMD_AVX512 static type splat( int32_t x ) { return _mm512_set1_epi32(x); }
+    SIMD_AVX512 static type min( type a, type b ) { return _mm512_mask_min_epi32(a, 0xFFFF, a, b); }
+    SIMD_AVX512 static type max( type a, type b ) { return _mm512_mask_max_epi32(a, 0xFFFF, a, b); }
+    SIMD_AVX512 static void store( int32_t* p, type a ) { _mm512_storeu_si512(static_cast<void*>(p), a); }
+};
+
+template <class T>
+SIMD_AVX512 T sum_avx512( const T* p, size_t n ) {
+    typedef avx512_ops<T> ops;
+    constexpr size_t lanes = 64 / sizeof(T);
+    typename ops::type acc[4] = { ops::splat(0), ops::splat(0), ops::splat(0), ops::splat(0) };
+    size_t i = 0;
+    for (; i + 4 * lanes <= n; i += 4 * lanes)
+        for (size_t k = 0; k < 4; ++k)
+            acc[k] = ops::add(acc[k], ops::load(p + i + k * lanes));
+    T parts[lanes];
+    ops::store(parts, ops::add(ops::add(acc[0], acc[1]), ops::add(acc[2], acc[3])));
+    return sum_scalar(parts, lanes) + sum_scalar(p + i, n - i);
+}
+
+template <class T>
+SIMD_AVX512 T dot_avx512( const T* a, const T* b, size_t n ) {
+    typedef avx512_ops<T> ops;
+    constexpr size_t lanes = 64 / sizeof(T);
+    typename ops::type acc[4] = { ops::splat(0), ops::splat(0), ops::splat(0), ops::splat(0) };
+    size_t i = 0;
+    for (; i + 4 * lanes <= n; i += 4 * lanes)
+        for (size_t k = 0; k < 4; ++k)
+            acc[k] = ops::add(acc[k], ops::mul(ops::load(a + i + k * lanes), ops::load(b + i + k * lanes)));
+    T parts[lanes];
+    ops::store(parts, ops::add(ops::add(acc[0], acc[1]), ops::add(acc[2], acc[3])));
+    return sum_scalar(parts, lanes) + dot_scalar(a + i, b + i, n - i);
+}
+
+template <class T>
+SIMD_AVX512 std::pair<T, T> minmax_avx512( const T* p, size_t n ) {
+    typedef avx512_ops<T> ops;
+    constexpr size_t lanes = 64 / sizeof(T);
+    if (n < 2 * lanes)
+        return minmax_scalar(p, n);
+    typename ops::type lo[2] = { ops::splat(p[0]), ops::splat(p[0]) }, hi[2] = { lo[0], lo[0] };
+    size_t i = 0;
+    for (; i + 2 * lanes <= n; i += 2 * lanes)
+        for (size_t k = 0; k < 2; ++k) {
+            typename ops::type x = ops::load(p + i + k * lanes);
+            lo[k] = ops::min(lo[k], x);
+            hi[k] = ops::max(hi[k], x);
+        }
+    T low[lanes], high[lanes];
+    ops::store(low, ops::min(lo[0], lo[1]));
+    ops::store(high, ops::max(hi[0], hi[1]));
+    std::pair<T, T> result(minmax_scalar(low, lanes).first, minmax_scalar(high, lanes).second);
+    if (i < n) {
+        std::pair<T, T> rest = minmax_scalar(p + i, n - i);
+        result.first = rest.first < result.first ? rest.first : result.first;
+        result.second = result.second < rest.second ? rest.second : result.second;
+    }
+    return result;
+}
+
+SIMD_AVX512 inline long long sum_int32_avx512( const int32_t* p, size_t n ) {
+    __m512i acc[2] = { _mm512_setzero_si512(), _mm512_setzero_si512() };
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+        for (size_t k = 0; k < 2; ++k)
+            acc[k] = _mm512_add_epi64(acc[k], _mm512_maskz_cvtepi32_epi64(0xFF, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i + 8 * k))));
+    long long parts[8];
+    _mm512_storeu_si512(static_cast<void*>(parts), _mm512_add_epi64(acc[0], acc[1]));
+    return sum_scalar(parts, 8) + sum_scalar(p + i, n - i);
+}
+#endif
+
+// Sum of [p, p + n), in sum_t<T>
+template <class T>
+sum_t<T> sum( const T* p, size_t n ) {
+    if constexpr (std::is_same<T, int32_t>::value) {
+        static const dispatch_table<long long (*)(const int32_t*, size_t)> table(
+            sum_scalar<int32_t>, SIMD_IF_SSE2(sum_int32_sse2), SIMD_IF_AVX2(sum_int32_avx2), SIMD_IF_AVX512(sum_int32_avx512));
+        return table()(p, n);
+    } else if constexpr (is_reducible<T>::value) {
+        static const dispatch_table<T (*)(const T*, size_t)> table(
+            sum_scalar<T>, SIMD_IF_SSE2(sum_sse2<T>), SIMD_IF_AVX2(sum_avx2<T>), SIMD_IF_AVX512(sum_avx512<T>));
+        return table()(p, n);
+    } else return sum_scalar(p, n);
+}
+
+// Number of elements summed by the fast kernels before sums are added pairwise
+constexpr size_t pairwise_block = 1024;
+
+template <class T>
+sum_t<T> sum_pairwise( const T* p, size_t n ) {
+    if (n <= pairwise_block)
+        return sum(p, n);
+    size_t half = (n / 2 + pairwise_block - 1) / pairwise_block * pairwise_block;   // Whole blocks first
+    return sum_pairwise(p, half) + sum_pairwise(p + half, n - half);
+}
+
+// Sum of [p, p + n) as *mode* tells. Integer sums are always exact
+template <class T>
+sum_t<T> sum( const T* p, size_t n, summation mode ) {
+    if constexpr (std::is_floating_point<T>::value) {
+        if (mode == summation::pairwise)
+            return sum_pairwise(p, n);
+        if (mode == summation::kahan)
+            return sum_kahan(p, n);
+    }
+    return sum(p, n);
+}
+
+// Sum of products of the elements of [a, a + n) and [b, b + n)
+template <class T>
+sum_t<T> dot( const T* a, const T* b, size_t n ) {
+    if constexpr (std::is_floating_point<T>::value && is_reducible<T>::value) {
+        static const dispatch_table<T (*)(const T*, const T*, size_t)> table(
+            dot_scalar<T>, SIMD_IF_SSE2(dot_sse2<T>), SIMD_IF_AVX2(dot_avx2<T>), SIMD_IF_AVX512(dot_avx512<T>));
+        return table()(a, b, n);
+    } else return dot_scalar(a, b, n);
+}
+
+// Smallest and largest of n >= 1 elements. If there are NaNs among them, the result is unspecified
+template <class T>
+std::pair<T, T> minmax( const T* p, size_t n ) {
+    if constexpr (is_reducible<T>::value) {
+        static const dispatch_table<std::pair<T, T> (*)(const T*, size_t)> table(
+            minmax_scalar<T>, SIMD_IF_SSE2(minmax_sse2<T>), SIMD_IF_AVX2(minmax_avx2<T>), SIMD_IF_AVX512(minmax_avx512<T>));
+        return table()(p, n);
+    } else return minmax_scalar(p, n);
+}
+
+}
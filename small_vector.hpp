@@ -0,0 +1,497 @@
+#pragma once
+
+#include "vector.hpp"
+
+// Vector which keeps up to N elements inside the object and
+// allocates memory only when it grows past them.
+// Has the same interface as vector, iterators are invalidated the same way
+template <class T, size_t N, class Allocator = std::allocator<T>>
+class small_vector {
+    public:
+        // Member types
+        typedef T value_type;
+        typedef Allocator allocator_type;
+        typedef std::allocator_traits<Allocator> alloc_traits;
+        typedef size_t size_type;
+        typedef value_type& reference;
+        typedef const value_type& const_reference;
+        typedef T* iterator;
+        typedef const T* const_iterator;
+        typedef std::reverse_iterator<iterator> reverse_iterator;
+        typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+        static constexpr size_type inline_capacity = N;
+
+        // Member functions
+        small_vector() noexcept(noexcept(Allocator())) : alloc() { create(); }
+        explicit small_vector(const Allocator& a) noexcept : alloc(a) { create(); }
+        explicit small_vector(size_type n, const T& val = T{}, const Allocator& a = Allocator())
+            : alloc(a) { build([&] { insert(end(), n, val); }); }
+        small_vector(std::initializer_list<T> array, const Allocator& a = Allocator()) // Create from array
+            : alloc(a) { build([&] { append(array.begin(), array.end()); }); }
+        small_vector(const small_vector& v)     // copy
+            : alloc(alloc_traits::select_on_container_copy_construction(v.alloc)) { build([&] { append(v.begin(), v.end()); }); }
+        small_vector(small_vector&& v) noexcept(std::is_nothrow_move_constructible<T>::value) // move
+            : alloc(std::move(v.alloc)) { create(); steal(v); }
+        ~small_vector() { uncreate(); }
+        small_vector& operator=(const small_vector&);   // copy assignment
+        small_vector& operator=(small_vector&&);        // move assignment
+        void assign( size_type count, const T& value );
+        allocator_type get_allocator() const { return alloc; };
+
+        // Element access
+        reference at( size_type i );
+        const_reference at( size_type i ) const;
+        T& operator[](size_type i) { return data[i]; }
+        const T& operator[](size_type i) const { return data[i]; }
+        reference front() { return *data; }
+        const_reference front() const { return *data; }
+        reference back() { return *(avail-1); }
+        const_reference back() const { return *(avail-1); }
+
+        // Iterators
+        iterator begin() noexcept { return data; }
+        const_iterator begin() const noexcept { return data; }
+        iterator end() noexcept { return avail; }
+        const_iterator end() const noexcept { return avail; }
+        reverse_iterator rbegin() noexcept { return reverse_iterator(avail); }
+        const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(avail); };
+        reverse_iterator rend() noexcept { return reverse_iterator(data); }
+        const_reverse_iterator rend() const noexcept { return const_reverse_iterator(data); };
+
+        // Capacity
+        bool empty() const { return (begin() == end()); }
+        size_type size() const { return avail - data; }
+        size_type capacity() const { return limit - data; }
+        bool is_inline() const { return data == inline_data(); }   // no memory is allocated
+        void reserve( size_type new_cap );
+        void shrink_to_fit();
+
+        // Modifiers
+        void clear();
+        iterator insert( const_iterator pos, const T& value );
+        iterator insert( const_iterator pos, size_type count, const T& value );
+        template <class... Args>
+        iterator emplace( const_iterator pos, Args&&... args );
+        iterator erase( iterator pos );
+        iterator erase( iterator first, iterator last );
+        void push_back(const T& val);
+        void push_back(T&& val);
+        template <class... Args>
+        reference emplace_back( Args&&... args );
+        void pop_back();
+        void resize( size_type count );
+        void resize( size_type count, const value_type& value );
+        void swap( small_vector& other );
+
+        // Operators
+        bool operator==(const small_vector& other) const;
+        bool operator!=(const small_vector& other) const;
+        bool operator<(const small_vector& other) const;
+        bool operator>(const small_vector& other) const;
+        bool operator>=(const small_vector& other) const;
+        bool operator<=(const small_vector& other) const;
+    private:
+        iterator data;        // first element, inline_data() until the vector spills to the heap
+        iterator avail;       // first element after the last vector element
+        iterator limit;       // first element outside the reserved space
+
+        allocator_type alloc;
+        alignas(T) unsigned char buffer[(N ? N : 1) * sizeof(T)];  // inline storage
+
+        iterator inline_data() { return reinterpret_cast<iterator>(buffer); }
+        const_iterator inline_data() const { return reinterpret_cast<const_iterator>(buffer); }
+
+        void create();        // point to the empty inline storage
+        void uncreate();      // destroy the elements and release the heap block
+        template <class It>
+        void append(It, It);  // copy a range to the end
+        template <class Fill>
+        void build(Fill);     // fill a new vector, freeing it all if an element throws
+        void steal(small_vector&);          // take over the elements of another vector
+        void destroy(iterator, iterator);   // destroy elements of a range backwards
+        iterator relocate(iterator, iterator, iterator); // move a range to raw memory
+        void reallocate(size_type);         // move elements to inline storage or a heap block
+        void grow(size_type);               // make room for given number of new elements
+};
+
+// Point to the empty inline storage
+template <class T, size_t N, class Allocator>
+void small_vector<T, N, Allocator>::create() {
+    data = avail = inline_data();
+    limit = data + N;
+}
+
+// Destroy the elements and release the heap block, if there is one
+template <class T, size_t N, class Allocator>
+void small_vector<T, N, Allocator>::uncreate() {
+    destroy(data, avail);
+    if (!is_inline())
+        alloc_traits::deallocate(alloc, data, limit - data);
+    create();
+}
+
+// Copy range [first, last) to the end of the vector
+template <class T, size_t N, class Allocator>
+template <class It>
+void small_vector<T, N, Allocator>::append( It first, It last ) {
+    reserve(size() + std::distance(first, last));
+    for (; first != last; ++first, ++avail)
+        alloc_traits::construct(alloc, avail, *first);
+}
+
+// Fill a vector under construction. Its destructor doesn't run if the
+// constructor throws, so the elements built so far and the heap block
+// are released here
+template <class T, size_t N, class Allocator>
+template <class Fill>
+void small_vector<T, N, Allocator>::build( Fill fill ) {
+    create();
+    try {
+        fill();
+    } catch (...) {
+        uncreate();
+        throw;
+    }
+}
+
+// Take over the elements of *other*, which is left empty. A heap block
+// changes its owner, inline elements are moved one by one
+template <class T, size_t N, class Allocator>
+void small_vector<T, N, Allocator>::steal( small_vector& other ) {
+    if (other.is_inline()) {
+        avail = relocate(other.data, other.avail, data);
+        other.avail = other.data;
+    } else {
+        data = other.data;
+        avail = other.avail;
+        limit = other.limit;
+        other.create();
+    }
+}
+
+// Destroy elements of range [first, last) backwards
+template <class T, size_t N, class Allocator>
+void small_vector<T, N, Allocator>::destroy( iterator first, iterator last ) {
+    if constexpr (!std::is_trivially_destructible<T>::value)
+        while (last != first)
+            alloc_traits::destroy(alloc, --last);
+}
+
+// Move the elements of range [first, last) to raw memory at dest and end
+// their lifetime at the old place. Returns the end of the new range
+template <class T, size_t N, class Allocator>
+typename small_vector<T, N, Allocator>::iterator small_vector<T, N, Allocator>::relocate( iterator first, iterator last, iterator dest ) {
+    if constexpr (is_trivially_relocatable<T>::value) {
+        if (first != last)
+            std::memcpy(static_cast<void*>(dest), static_cast<const void*>(first),
+                        (last - first) * sizeof(T));
+        return dest + (last - first);
+    } else {
+        iterator it = dest;
+        try {
+            for (iterator i = first; i != last; ++i, ++it)
+                alloc_traits::construct(alloc, it, std::move_if_noexcept(*i));
+        } catch (...) {
+            destroy(dest, it);
+            throw;
+        }
+        destroy(first, last);
+        return it;
+    }
+}
+
+// Move the elements to a heap block of *new_cap* capacity,
+// or back to the inline storage if they fit into it
+template <class T, size_t N, class Allocator>
+void small_vector<T, N, Allocator>::reallocate( size_type new_cap ) {
+    iterator old_data = data, old_limit = limit;
+    bool was_inline = is_inline();
+    iterator new_data = new_cap > N ? alloc_traits::allocate(alloc, new_cap) : inline_data();
+    iterator new_avail;
+    try {
+        new_avail = relocate(data, avail, new_data);
+    } catch (...) {
+        if (new_data != inline_data())
+            alloc_traits::deallocate(alloc, new_data, new_cap);
+        throw;
+    }
+    data = new_data;
+    avail = new_avail;
+    limit = new_data == inline_data() ? data + N : data + new_cap;
+    if (!was_inline)
+        alloc_traits::deallocate(alloc, old_data, old_limit - old_data);
+}
+
+// Make room for *count* new elements, doubling the capacity
+template <class T, size_t N, class Allocator>
+void small_vector<T, N, Allocator>::grow( size_type count ) {
+    if (size_type(limit - avail) < count)
+        reallocate(grow_twice::grow(capacity(), size() + count, sizeof(T)));
+}
+
+// Assignment operator
+template <class T, size_t N, class Allocator>
+small_vector<T, N, Allocator>& small_vector<T, N, Allocator>::operator=(const small_vector& rhs) {
+    if (&rhs != this) {
+        if constexpr (alloc_traits::propagate_on_container_copy_assignment::value) {
+            if (alloc != rhs.alloc)
+                uncreate();     // The block must be released with the old allocator
+            alloc = rhs.alloc;
+        }
+        clear();                // Keep the reserved space
+        append(rhs.begin(), rhs.end());
+    }
+    return *this;
+}
+
+// Move assignment operator, takes over the heap block of rhs if it has one
+template <class T, size_t N, class Allocator>
+small_vector<T, N, Allocator>& small_vector<T, N, Allocator>::operator=(small_vector&& rhs) {
+    if (&rhs != this) {
+        uncreate();
+        if constexpr (alloc_traits::propagate_on_container_move_assignment::value)
+            alloc = std::move(rhs.alloc);
+        if (alloc_traits::propagate_on_container_move_assignment::value || alloc == rhs.alloc)
+            steal(rhs);
+        else {  // This allocator can't free rhs's block
+            append(std::make_move_iterator(rhs.begin()), std::make_move_iterator(rhs.end()));
+            rhs.clear();
+        }
+    }
+    return *this;
+}
+
+// Replace the contents with *count* copies of *value* value
+template <class T, size_t N, class Allocator>
+void small_vector<T, N, Allocator>::assign( size_type count, const T& value ) {
+    if (count < 1)
+        throw std::invalid_argument{ "small_vector::assign" };
+    T copy(value);              // value may be an element of this vector
+    clear();
+    insert(end(), count, copy);
+}
+
+// Element access funtions
+template <class T, size_t N, class Allocator>
+typename small_vector<T, N, Allocator>::reference small_vector<T, N, Allocator>::at( size_type i ) {
+    if (i < size())
+        return data[i];
+    else throw std::out_of_range {"small_vector::at"};
+}
+
+template <class T, size_t N, class Allocator>
+typename small_vector<T, N, Allocator>::const_reference small_vector<T, N, Allocator>::at( size_type i ) const {
+    if (i < size())
+        return data[i];
+    else throw std::out_of_range {"small_vector::at"};
+}
+
+// Reserve space for *new_cap* elements
+template <class T, size_t N, class Allocator>
+void small_vector<T, N, Allocator>::reserve( size_type new_cap ) {
+    if (new_cap > capacity())
+        reallocate(new_cap);
+}
+
+// Release unused heap memory, moving the elements inline if they fit
+template <class T, size_t N, class Allocator>
+void small_vector<T, N, Allocator>::shrink_to_fit() {
+    if (!is_inline() && avail != limit)
+        reallocate(size());
+}
+
+// Delete all elements, don't deallocate space
+template <class T, size_t N, class Allocator>
+void small_vector<T, N, Allocator>::clear() {
+    destroy(data, avail);
+    avail = data;
+}
+
+// Insert *value* at *pos* position
+template <class T, size_t N, class Allocator>
+typename small_vector<T, N, Allocator>::iterator small_vector<T, N, Allocator>::insert( const_iterator pos, const T& value ) {
+    return emplace(pos, value);
+}
+
+// Insert *count* copies of *value* at *pos* position
+template <class T, size_t N, class Allocator>
+typename small_vector<T, N, Allocator>::iterator small_vector<T, N, Allocator>::insert( const_iterator pos, size_type count, const T& value ) {
+    if (pos < data || pos > avail)
+        throw std::out_of_range{ "small_vector::insert" };
+    size_type offset = pos - data;
+    if (count == 0)
+        return data + offset;
+
+    T copy(value);              // value may be an element of this vector
+    grow(count);
+    iterator it = data + offset;
+    size_type tail = avail - it;
+    if (tail > count) {
+        // The last *count* elements move to raw memory, the rest is shifted
+        for (iterator i = avail - count; i != avail; ++i)
+            alloc_traits::construct(alloc, i + count, std::move(*i));
+        std::move_backward(it, avail - count, avail);
+        std::fill(it, it + count, copy);
+    } else {
+        // The whole tail moves to raw memory, some copies land past it
+        iterator i = avail;
+        try {
+            for (; i != it + count; ++i)
+                alloc_traits::construct(alloc, i, copy);
+        } catch (...) {
+            destroy(avail, i);  // The copies past the end aren't elements yet
+            throw;
+        }
+        for (iterator i = it; i != avail; ++i)
+            alloc_traits::construct(alloc, i + count, std::move(*i));
+        std::fill(it, avail, copy);
+    }
+    avail += count;
+    return it;
+}
+
+// Construct a new element in place before *pos* position
+template <class T, size_t N, class Allocator>
+template <class... Args>
+typename small_vector<T, N, Allocator>::iterator small_vector<T, N, Allocator>::emplace( const_iterator pos, Args&&... args ) {
+    if (pos < data || pos > avail)
+        throw std::out_of_range{ "small_vector::emplace" };
+    size_type offset = pos - data;
+    if (pos == avail) {
+        emplace_back(std::forward<Args>(args)...);
+        return data + offset;
+    }
+
+    T value(std::forward<Args>(args)...);   // args may refer to elements of this vector
+    grow(1);
+    iterator it = data + offset;
+    alloc_traits::construct(alloc, avail, std::move(*(avail - 1))); // Move the last element to raw space
+    ++avail;
+    std::move_backward(it, avail - 2, avail - 1);    // Shift the rest by one position
+    *it = std::move(value);
+    return it;
+}
+
+// Erase element at pos position
+template <class T, size_t N, class Allocator>
+typename small_vector<T, N, Allocator>::iterator small_vector<T, N, Allocator>::erase( iterator pos ) {
+    if (pos < data || pos >= avail)
+        throw std::out_of_range{ "small_vector::erase" };
+    std::move(pos + 1, avail, pos);  // Move values by one position to the left
+    alloc_traits::destroy(alloc, --avail);
+    return pos;
+}
+
+// Erase elements in a range
+template <class T, size_t N, class Allocator>
+typename small_vector<T, N, Allocator>::iterator small_vector<T, N, Allocator>::erase( iterator first, iterator last ) {
+    if (last < first)
+        throw std::invalid_argument{ "small_vector::erase" };
+    if (first < data || last > avail)
+        throw std::out_of_range{ "small_vector::erase" };
+    iterator new_avail = std::move(last, avail, first);
+    destroy(new_avail, avail);
+    avail = new_avail;
+    return first;
+}
+
+// Add an element to the back of the vector
+template <class T, size_t N, class Allocator>
+void small_vector<T, N, Allocator>::push_back(const T& val){
+    emplace_back(val);
+}
+
+// Move an element to the back of the vector
+template <class T, size_t N, class Allocator>
+void small_vector<T, N, Allocator>::push_back(T&& val){
+    emplace_back(std::move(val));
+}
+
+// Construct a new element in place at the end of the vector
+template <class T, size_t N, class Allocator>
+template <class... Args>
+typename small_vector<T, N, Allocator>::reference small_vector<T, N, Allocator>::emplace_back( Args&&... args ) {
+    if (avail == limit) {
+        // Build the element before the old storage is released, args may refer into it
+        T value(std::forward<Args>(args)...);
+        grow(1);
+        alloc_traits::construct(alloc, avail, std::move(value));
+    } else
+        alloc_traits::construct(alloc, avail, std::forward<Args>(args)...);
+    return *avail++;
+}
+
+// Delete the last element of the vector
+template <class T, size_t N, class Allocator>
+void small_vector<T, N, Allocator>::pop_back(){
+    alloc_traits::destroy(alloc, avail - 1);
+    avail--;
+}
+
+// Leave the vector with *count* elements only (count<size)
+template <class T, size_t N, class Allocator>
+void small_vector<T, N, Allocator>::resize( size_type count ) {
+    if (count > size())
+        throw std::invalid_argument{ "small_vector::resize" };
+    destroy(data + count, avail);
+    avail = data + count;
+}
+
+// If the current size is less than count, additional elements are
+// appended and initialized with copies of value
+template <class T, size_t N, class Allocator>
+void small_vector<T, N, Allocator>::resize( size_type count, const value_type& value ) {
+    if (size() > count)
+        resize(count);
+    else
+        insert(end(), count - size(), value);
+}
+
+// Exchange the contents of the container with those of other.
+// Heap blocks are swapped in O(1), inline elements are moved
+template <class T, size_t N, class Allocator>
+void small_vector<T, N, Allocator>::swap( small_vector& other ) {
+    if (!is_inline() && !other.is_inline()) {
+        if constexpr (alloc_traits::propagate_on_container_swap::value)
+            std::swap(alloc, other.alloc);
+        std::swap(data, other.data);
+        std::swap(avail, other.avail);
+        std::swap(limit, other.limit);
+    } else {
+        small_vector temp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(temp);
+    }
+}
+
+// Check if both vectors have the same size and values
+template <class T, size_t N, class Allocator>
+bool small_vector<T, N, Allocator>::operator==(const small_vector& other) const {
+    return size() == other.size() && equal_elements(begin(), other.begin(), size());
+}
+
+template <class T, size_t N, class Allocator>
+bool small_vector<T, N, Allocator>::operator!=(const small_vector& other) const {
+    return !(*this == other);
+}
+
+// Compare vectors lexicographically
+template <class T, size_t N, class Allocator>
+bool small_vector<T, N, Allocator>::operator<(const small_vector& other) const {
+    return compare_elements(begin(), size(), other.begin(), other.size()) < 0;
+}
+
+template <class T, size_t N, class Allocator>
+bool small_vector<T, N, Allocator>::operator>(const small_vector& other) const {
+    return other < *this;
+}
+
+template <class T, size_t N, class Allocator>
+bool small_vector<T, N, Allocator>::operator<=(const small_vector& other) const {
+    return !(other < *this);
+}
+
+template <class T, size_t N, class Allocator>
+bool small_vector<T, N, Allocator>::operator>=(const small_vector& other) const {
+    return !(*this < other);
+}
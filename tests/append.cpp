@@ -0,0 +1,41 @@
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include "../vector.hpp"
+#include "timer.h"
+
+const size_t totalCount = 100000000;
+
+// Add *totalCount* integers in batches of *batchSize*, one push_back at a time
+double measurePushBack (const std::vector<int>& batch) {
+    vector<int> container;
+    Timer T;
+    T.set();
+    for (size_t added = 0; added < totalCount; added += batch.size())
+        for (int x : batch)
+            container.push_back(x);
+    return T.elapsed();
+}
+
+// Add the same batches with a single append() each
+double measureAppend (const std::vector<int>& batch) {
+    vector<int> container;
+    Timer T;
+    T.set();
+    for (size_t added = 0; added < totalCount; added += batch.size())
+        container.append(batch.begin(), batch.end());
+    return T.elapsed();
+}
+
+int main() {
+    std::cout << std::setw(8) << "batch" << std::setw(14) << "push_back" << std::setw(14) << "append\n";
+    for (size_t batchSize : {1, 16, 256, 4096, 65536}) {
+        std::vector<int> batch(batchSize);
+        for (size_t i = 0; i < batchSize; ++i)
+            batch[i] = int(i);
+        std::cout << std::setw(8) << batchSize
+                  << std::setw(13) << measurePushBack(batch) << "s"
+                  << std::setw(13) << measureAppend(batch) << "s\n";
+    }
+    return 0;
+}
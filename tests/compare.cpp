@@ -0,0 +1,58 @@
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include "../vector.hpp"
+#include "timer.h"
+
+const size_t totalElements = 1000000000;
+
+// Element by element comparison through at(), as the operators used to do
+template <class T>
+bool naiveLess (const vector<T>& a, const vector<T>& b) {
+    size_t common = std::min(a.size(), b.size());
+    for (size_t i = 0; i < common; i++)
+        if (a.at(i) != b.at(i))
+            return a.at(i) < b.at(i);
+    return a.size() < b.size();
+}
+
+// Compare two vectors of *sz* equal elements, but the last, until
+// *totalElements* elements are scanned. Returns seconds per run
+template <class Container, class Compare>
+double measure (size_t sz, Compare compare) {
+    Container a(sz, 1), b(sz, 1);
+    b[sz - 1] = 2;
+    size_t repeatCount = totalElements / sz, hits = 0;
+    Timer T;
+    T.set();
+    for (size_t r = 0; r < repeatCount; ++r)
+        hits += compare(a, b);
+    double time = T.elapsed();
+    if (hits != repeatCount)    // Keep the loop from being optimized away
+        std::cout << "wrong result\n";
+    return time;
+}
+
+template <class T>
+void measureType (const char* name) {
+    std::cout << name << "\n" << std::setw(10) << "size" << std::setw(14) << "at() <"
+              << std::setw(14) << "std <" << std::setw(14) << "vector <"
+              << std::setw(14) << "std ==" << std::setw(14) << "vector ==\n";
+    for (size_t sz : {16, 1000, 100000, 10000000}) {
+        std::cout << std::setw(10) << sz
+                  << std::setw(13) << measure<vector<T>>(sz, naiveLess<T>) << "s"
+                  << std::setw(13) << measure<std::vector<T>>(sz, [](auto& a, auto& b) { return a < b; }) << "s"
+                  << std::setw(13) << measure<vector<T>>(sz, [](auto& a, auto& b) { return a < b; }) << "s"
+                  << std::setw(13) << measure<std::vector<T>>(sz, [](auto& a, auto& b) { return a != b; }) << "s"
+                  << std::setw(13) << measure<vector<T>>(sz, [](auto& a, auto& b) { return a != b; }) << "s\n";
+    }
+    std::cout << "\n";
+}
+
+int main() {
+    std::cout << "SIMD level: " << simd::level_name(simd::active_level()) << " (set VECTOR_SIMD_LEVEL to scalar, sse2, avx2 or avx512 to change it)\n\n";
+    measureType<unsigned char>("unsigned char");
+    measureType<int>("int");
+    measureType<double>("double");
+    return 0;
+}
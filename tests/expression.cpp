@@ -0,0 +1,80 @@
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include "../expression.hpp"
+#include "timer.h"
+
+const size_t totalBytes = size_t(4) << 30;  // Read and written by each measurement
+
+// Element-wise functions returning new vectors, as r = b * c + d was written before
+template <class T>
+vector<T> multiply (const vector<T>& a, const vector<T>& b) {
+    vector<T> result(a.size());
+    for (size_t i = 0; i < a.size(); ++i)
+        result[i] = a[i] * b[i];
+    return result;
+}
+
+template <class T>
+vector<T> add (const vector<T>& a, const vector<T>& b) {
+    vector<T> result(a.size());
+    for (size_t i = 0; i < a.size(); ++i)
+        result[i] = a[i] + b[i];
+    return result;
+}
+
+// Compute r from b, c and d, *bytes* bytes each, until *totalBytes* bytes
+// are read and written, returns the speed in GB/s
+template <class Value, class Compute>
+double measure (size_t bytes, Compute compute) {
+    size_t n = bytes / sizeof(Value);
+    vector<Value> b(n), c(n), d(n), r(n);
+    for (size_t i = 0; i < n; ++i) {
+        b[i] = Value(i % 100) / 100;
+        c[i] = Value(i % 7);
+        d[i] = Value(i % 3);
+    }
+    size_t repeatCount = std::max(totalBytes / (4 * bytes), size_t(1));
+    Timer T;
+    T.set();
+    for (size_t rep = 0; rep < repeatCount; ++rep) {
+        d[rep % n] = Value(rep % 3);    // Keep compute() from being hoisted out of the loop
+        compute(r, b, c, d);
+    }
+    double time = T.elapsed();
+    if (r[n / 2] == Value(42))          // Keep the results alive
+        std::cout << "";
+    return double(repeatCount) * 4 * bytes / time / 1e9;
+}
+
+template <class T>
+void measureType (const char* name) {
+    typedef vector<T> V;
+    std::cout << name << " (GB/s)\n" << std::setw(10) << "size" << std::setw(14) << "temporaries"
+              << std::setw(12) << "loop" << std::setw(12) << "expression"
+              << std::setw(14) << "where loop" << std::setw(14) << "where expr\n";
+    // From L1 to far past the last level cache
+    for (size_t bytes : {size_t(4) << 10, size_t(64) << 10, size_t(1) << 20, size_t(64) << 20}) {
+        std::cout << std::setw(8) << (bytes >> 10) << "KB" << std::fixed << std::setprecision(2)
+                  << std::setw(14) << measure<T>(bytes, [](V& r, const V& b, const V& c, const V& d) { r = add(multiply(b, c), d); })
+                  << std::setw(12) << measure<T>(bytes, [](V& r, const V& b, const V& c, const V& d) {
+                         for (size_t i = 0; i < r.size(); ++i)
+                             r[i] = b[i] * c[i] + d[i];
+                     })
+                  << std::setw(12) << measure<T>(bytes, [](V& r, const V& b, const V& c, const V& d) { r = b * c + d; })
+                  << std::setw(14) << measure<T>(bytes, [](V& r, const V& b, const V& c, const V& d) {
+                         for (size_t i = 0; i < r.size(); ++i)
+                             r[i] = b[i] > T(0.5) ? std::sqrt(b[i]) * c[i] : d[i];
+                     })
+                  << std::setw(13) << measure<T>(bytes, [](V& r, const V& b, const V& c, const V& d) { r = where(b > T(0.5), sqrt(b) * c, d); })
+                  << "\n" << std::defaultfloat;
+    }
+    std::cout << "\n";
+}
+
+int main() {
+    std::cout << "SIMD level: " << simd::level_name(simd::active_level()) << " (set VECTOR_SIMD_LEVEL to scalar, sse2, avx2 or avx512 to change it)\n\n";
+    measureType<float>("float");
+    measureType<double>("double");
+    return 0;
+}
@@ -1,8 +1,24 @@
 #define CATCH_CONFIG_MAIN
+#define VECTOR_STATS        // Vectors count their allocations, see test 35
 
+#include <atomic>
+#include <climits>
+#include <cmath>
 #include <iostream>
+#include <list>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
 #include <vector>           // std::vector container
 #include "../vector.hpp"    // Custom vector class
+#include "../remap_allocator.hpp"
+#include "../small_vector.hpp"
+#include "../inplace_vector.hpp"
+#include "../aligned_allocator.hpp"
+#include "../expression.hpp"
+#include "../incremental_vector.hpp"
+#include "../segmented_vector.hpp"
 #include "catch.hpp"        // Catch framework
 
 
@@ -278,4 +294,1357 @@ TEST_CASE("13. Operators") {
         REQUIRE ((fake4 >= fake2) == false);
         REQUIRE ((fake1 >= fake3) == true);
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("14. Move semantics") {
+    vector<std::string> fake{"alpha", "beta", "gamma"};
+    std::vector<std::string> real{"alpha", "beta", "gamma"};
+    const std::string* buffer = &fake[0];
+
+    SECTION ("Move constructor") {
+        vector<std::string> fakeMoved(std::move(fake));
+        std::vector<std::string> realMoved(std::move(real));
+
+        REQUIRE(fakeMoved.size() == realMoved.size());
+        REQUIRE(&fakeMoved[0] == buffer);   // Buffer was stolen, not copied
+        REQUIRE(fake.empty());
+        REQUIRE(fake.capacity() == 0);
+        for (int i = 0; i < fakeMoved.size(); i ++)
+            REQUIRE(fakeMoved[i] == realMoved[i]);
+    }
+    SECTION ("Move assignment") {
+        vector<std::string> fakeMoved{"delta"};
+        fakeMoved = std::move(fake);
+
+        REQUIRE(fakeMoved.size() == 3);
+        REQUIRE(&fakeMoved[0] == buffer);
+        REQUIRE(fake.empty());
+
+        fake = std::move(fakeMoved);        // Moved-from vector is reusable
+        REQUIRE(fake.size() == 3);
+        REQUIRE(fake.back() == "gamma");
+    }
+    SECTION ("Push back rvalue") {
+        std::string value(100, 'x');
+        const char* chars = value.data();
+        fake.push_back(std::move(value));
+        real.push_back("x");
+
+        REQUIRE(fake.size() == real.size());
+        REQUIRE(fake.back().data() == chars); // String contents were moved in
+    }
+}
+
+
+struct Record {
+    std::string name, surname;
+    vector<double> scores;
+    Record(const std::string& n, const std::string& s, std::initializer_list<double> sc)
+        : name(n), surname(s), scores(sc) {}
+};
+
+TEST_CASE("15. Emplace") {
+    SECTION ("Emplace back") {
+        vector<Record> fake;
+        Record& added = fake.emplace_back("Vardenis", "Pavardenis", std::initializer_list<double>{9, 10});
+
+        REQUIRE(fake.size() == 1);
+        REQUIRE(&added == &fake.back());
+        REQUIRE(added.surname == "Pavardenis");
+        REQUIRE(added.scores.size() == 2);
+    }
+    SECTION ("Emplace at position") {
+        vector<std::string> fake{"a", "b", "d"};
+        std::vector<std::string> real{"a", "b", "d"};
+
+        auto itfake = fake.emplace(fake.begin() + 2, 1, 'c');
+        auto itreal = real.emplace(real.begin() + 2, 1, 'c');
+        REQUIRE(*itfake == *itreal);
+        fake.emplace(fake.end(), "e");
+        real.emplace(real.end(), "e");
+
+        REQUIRE(fake.size() == real.size());
+        for (int i = 0; i < fake.size(); i ++)
+            REQUIRE(fake[i] == real[i]);
+    }
+    SECTION ("Element of the same vector") {
+        vector<std::string> fake{"first", "second"};
+        fake.shrink_to_fit();
+        fake.push_back(fake[0]);            // Reallocates while reading fake[0]
+        fake.emplace(fake.begin(), fake[1]);
+
+        REQUIRE(fake.size() == 4);
+        REQUIRE(fake[0] == "second");
+        REQUIRE(fake[3] == "first");
+    }
+}
+
+
+// Counts copies and moves made by the container while relocating
+template <bool NoexceptMove>
+struct Tracked {
+    static int copies, moves;
+    int value;
+    Tracked(int v) : value(v) {}
+    Tracked(const Tracked& other) : value(other.value) { copies++; }
+    Tracked(Tracked&& other) noexcept(NoexceptMove) : value(other.value) { moves++; }
+};
+template <bool NoexceptMove> int Tracked<NoexceptMove>::copies = 0;
+template <bool NoexceptMove> int Tracked<NoexceptMove>::moves = 0;
+
+struct Relocatable : Tracked<true> { using Tracked<true>::Tracked; };
+template <> struct is_trivially_relocatable<Relocatable> : std::true_type {};
+
+TEST_CASE("16. Relocation on reserve") {
+    SECTION ("Noexcept move constructor is used") {
+        vector<Tracked<true>> fake{1, 2, 3};
+        Tracked<true>::copies = Tracked<true>::moves = 0;
+        fake.reserve(10);
+
+        REQUIRE(Tracked<true>::copies == 0);
+        REQUIRE(Tracked<true>::moves == 3);
+        REQUIRE(fake[2].value == 3);
+    }
+    SECTION ("Throwing move constructor is not used") {
+        vector<Tracked<false>> fake{1, 2, 3};
+        Tracked<false>::copies = Tracked<false>::moves = 0;
+        fake.reserve(10);
+
+        REQUIRE(Tracked<false>::copies == 3);
+        REQUIRE(Tracked<false>::moves == 0);
+    }
+    SECTION ("Trivially relocatable type is copied bytewise") {
+        vector<Relocatable> fake{1, 2, 3};
+        Relocatable::copies = Relocatable::moves = 0;
+        fake.reserve(10);
+        fake.shrink_to_fit();
+
+        REQUIRE(Relocatable::copies == 0);
+        REQUIRE(Relocatable::moves == 0);
+        REQUIRE(fake.capacity() == 3);
+        REQUIRE(fake[1].value == 2);
+    }
+}
+
+
+TEST_CASE("17. Remap allocator") {
+    vector<int, remap_allocator<int>> fake;
+    std::vector<int> real;
+
+    // Grows from malloc'ed blocks to mapped pages, past the remap threshold
+    for (int i = 0; i < 1000000; i ++) {
+        fake.push_back(i);
+        real.push_back(i);
+    }
+    REQUIRE(fake.size() == real.size());
+    REQUIRE(fake.capacity() == real.capacity());
+    REQUIRE(std::equal(fake.begin(), fake.end(), real.begin()));
+
+    fake.resize(10);
+    fake.shrink_to_fit();
+    REQUIRE(fake.capacity() == 10);
+    REQUIRE(fake.back() == 9);
+
+    vector<std::string, remap_allocator<std::string>> strings{"a", "b"};
+    strings.push_back("c");             // Not trivially relocatable, moved one by one
+    REQUIRE(strings[2] == "c");
+}
+
+
+template <class Growth>
+std::vector<size_t> capacities(int count) {
+    vector<int, std::allocator<int>, Growth> fake;
+    std::vector<size_t> result;
+    for (int i = 0; i < count; i ++) {
+        if (fake.size() == fake.capacity())
+            result.push_back(Growth::grow(fake.capacity(), fake.size() + 1, sizeof(int)));
+        fake.push_back(i);
+        if (result.back() != fake.capacity())
+            result.push_back(0);        // Growth policy was not followed
+    }
+    return result;
+}
+
+TEST_CASE("18. Growth policies") {
+    REQUIRE(capacities<grow_twice>(20) == std::vector<size_t>{1, 2, 4, 8, 16, 32});
+    REQUIRE(capacities<grow_one_and_half>(20) == std::vector<size_t>{1, 2, 3, 4, 6, 9, 13, 19, 28});
+    REQUIRE(capacities<grow_golden>(20) == std::vector<size_t>{1, 2, 3, 4, 6, 9, 14, 22});
+    REQUIRE(capacities<grow_page_rounded<>>(2000) == std::vector<size_t>{1, 2, 4, 8, 16, 32, 64, 128, 256, 512, 1024, 2048});
+    REQUIRE(capacities<grow_page_rounded<grow_golden>>(2000).back() == 2048);
+    REQUIRE(capacities<grow_linear_above<64>>(50) == std::vector<size_t>{1, 2, 4, 8, 16, 32, 48, 64});
+
+    vector<int> fake(3, 10);
+    std::vector<int> real(3, 10);
+    fake.push_back(4);                  // Default policy matches std::vector
+    real.push_back(4);
+    REQUIRE(fake.capacity() == real.capacity());
+}
+
+
+// Stateful allocator, allocators with different ids can't free each other's blocks
+template <class T, bool Propagate>
+struct TaggedAllocator {
+    typedef T value_type;
+    typedef std::integral_constant<bool, Propagate> propagate_on_container_copy_assignment;
+    typedef std::integral_constant<bool, Propagate> propagate_on_container_move_assignment;
+    typedef std::integral_constant<bool, Propagate> propagate_on_container_swap;
+    int id;
+    static int constructed;
+
+    TaggedAllocator(int i = 0) : id(i) {}
+    template <class U>
+    TaggedAllocator(const TaggedAllocator<U, Propagate>& other) : id(other.id) {}
+    T* allocate(size_t n) { return std::allocator<T>().allocate(n); }
+    void deallocate(T* p, size_t n) { std::allocator<T>().deallocate(p, n); }
+    template <class... Args>
+    void construct(T* p, Args&&... args) { constructed++; ::new(static_cast<void*>(p)) T(std::forward<Args>(args)...); }
+    bool operator==(const TaggedAllocator& other) const { return id == other.id; }
+    bool operator!=(const TaggedAllocator& other) const { return id != other.id; }
+};
+template <class T, bool Propagate> int TaggedAllocator<T, Propagate>::constructed = 0;
+
+TEST_CASE("19. Allocator awareness") {
+    typedef TaggedAllocator<int, true> Propagating;
+    typedef TaggedAllocator<int, false> Sticky;
+
+    SECTION ("Elements are constructed through the allocator") {
+        Sticky::constructed = 0;
+        vector<int, Sticky> fake(3, 7, Sticky(1));
+        fake.push_back(8);
+        fake.emplace(fake.begin(), 6);
+
+        REQUIRE(Sticky::constructed == 5);  // ints are relocated bytewise on growth
+        REQUIRE(fake.get_allocator().id == 1);
+    }
+    SECTION ("Propagating allocator") {
+        vector<int, Propagating> fake1({1, 2, 3}, Propagating(1)), fake2({4, 5}, Propagating(2));
+        const int* buffer = &fake2[0];
+
+        fake1.swap(fake2);
+        REQUIRE(fake1.get_allocator().id == 2);
+        REQUIRE(&fake1[0] == buffer);       // O(1), the block changed owner
+
+        fake2 = fake1;
+        REQUIRE(fake2.get_allocator().id == 2);
+
+        vector<int, Propagating> fake3(Propagating(3));
+        fake3 = std::move(fake1);
+        REQUIRE(fake3.get_allocator().id == 2);
+        REQUIRE(&fake3[0] == buffer);
+    }
+    SECTION ("Non-propagating allocator") {
+        vector<int, Sticky> fake1({1, 2, 3}, Sticky(1)), fake2({4, 5}, Sticky(2));
+        const int* buffer = &fake1[0];
+
+        fake2 = fake1;
+        REQUIRE(fake2.get_allocator().id == 2);
+        REQUIRE(fake2.size() == 3);
+
+        vector<int, Sticky> fake3(Sticky(3));
+        fake3 = std::move(fake1);           // Unequal allocators, elements are moved
+        REQUIRE(fake3.get_allocator().id == 3);
+        REQUIRE(&fake3[0] != buffer);
+        REQUIRE(fake3[2] == 3);
+
+        vector<int, Sticky> fake4(std::move(fake3), Sticky(3));
+        REQUIRE(fake4.size() == 3);
+        REQUIRE(fake3.empty());
+    }
+}
+
+
+TEST_CASE("20. Polymorphic memory resource") {
+    char buffer[4096];
+    std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+
+    pmr::vector<int> fake(&arena);
+    for (int i = 0; i < 100; i ++)
+        fake.push_back(i);
+    REQUIRE(fake.get_allocator().resource() == &arena);
+    REQUIRE((char*)&fake[0] >= buffer);
+    REQUIRE((char*)&fake[99] < buffer + sizeof(buffer));
+
+    // Nested containers get the same resource
+    pmr::vector<std::pmr::string> strings(&arena);
+    strings.emplace_back("longer than the small string buffer");
+    strings.push_back(strings[0]);
+    REQUIRE(strings[1].get_allocator().resource() == &arena);
+
+    pmr::vector<pmr::vector<int>> nested(&arena);
+    nested.emplace_back(3, 7);
+    REQUIRE(nested[0].get_allocator().resource() == &arena);
+    REQUIRE(nested[0][2] == 7);
+}
+
+
+// Copying throws once the countdown reaches zero; counts the live objects
+struct ThrowingCopy {
+    static int countdown, live;
+    std::string value;
+    ThrowingCopy(const char* v) : value(v) { ++live; }
+    ThrowingCopy(const ThrowingCopy& other) : value(other.value) {
+        if (--countdown == 0)
+            throw std::runtime_error("copy");
+        ++live;
+    }
+    ThrowingCopy& operator=(const ThrowingCopy& other) = default;
+    ~ThrowingCopy() { --live; }
+};
+int ThrowingCopy::countdown = -1, ThrowingCopy::live = 0;
+
+TEST_CASE("21. Small vector") {
+    small_vector<std::string, 4> fake{"a", "b", "c"};
+    std::vector<std::string> real{"a", "b", "c"};
+
+    SECTION ("Inline storage") {
+        REQUIRE(fake.is_inline());
+        REQUIRE(fake.capacity() == 4);
+        fake.push_back("d");
+        REQUIRE(fake.is_inline());
+        fake.push_back("e");                // Spills to the heap
+        REQUIRE(!fake.is_inline());
+        REQUIRE(fake.capacity() == 8);
+        REQUIRE(fake[4] == "e");
+
+        fake.resize(2);
+        fake.shrink_to_fit();               // Moves back inline
+        REQUIRE(fake.is_inline());
+        REQUIRE(fake.back() == "b");
+    }
+    SECTION ("Insert and erase") {
+        fake.insert(fake.begin() + 1, "x");
+        real.insert(real.begin() + 1, "x");
+        fake.insert(fake.begin() + 2, 3, fake[0]);
+        real.insert(real.begin() + 2, 3, real[0]);
+        fake.emplace(fake.end(), 2, 'y');
+        real.emplace(real.end(), 2, 'y');
+        fake.erase(fake.begin(), fake.begin() + 2);
+        real.erase(real.begin(), real.begin() + 2);
+        fake.erase(fake.begin() + 3);
+        real.erase(real.begin() + 3);
+
+        REQUIRE(fake.size() == real.size());
+        REQUIRE(std::equal(fake.begin(), fake.end(), real.begin()));
+        REQUIRE(std::equal(fake.rbegin(), fake.rend(), real.rbegin()));
+    }
+    SECTION ("Copy, move and swap") {
+        small_vector<std::string, 4> copy(fake), big(10, "z");
+        REQUIRE(copy == fake);
+
+        small_vector<std::string, 4> moved(std::move(copy));
+        REQUIRE(moved == fake);
+        REQUIRE(copy.empty());
+
+        const std::string* buffer = &big[0];
+        moved.swap(big);
+        REQUIRE(&moved[0] == buffer);       // Heap block changed owner
+        REQUIRE(big == fake);
+        big = moved;
+        REQUIRE(big.size() == 10);
+    }
+    SECTION ("Operators") {
+        small_vector<int, 2> fake1(10, 5), fake2(10, 5), fake3(10, 3), fake4(4, 2);
+        REQUIRE(fake1 == fake2);
+        REQUIRE(fake1 != fake3);
+        REQUIRE(fake4 < fake2);
+        REQUIRE(fake1 > fake3);
+        REQUIRE(fake1 <= fake2);
+        REQUIRE(fake1 >= fake3);
+    }
+    SECTION ("Constructors release what they built when a copy throws") {
+        ThrowingCopy value("x");
+        ThrowingCopy::countdown = 40;
+        REQUIRE_THROWS_AS((small_vector<ThrowingCopy, 4>(100, value)), std::runtime_error);
+        REQUIRE(ThrowingCopy::live == 1);
+        small_vector<ThrowingCopy, 4> fake(10, value);
+        ThrowingCopy::countdown = 6;
+        REQUIRE_THROWS_AS((small_vector<ThrowingCopy, 4>(fake)), std::runtime_error);
+        ThrowingCopy::countdown = 3;
+        REQUIRE_THROWS_AS((small_vector<ThrowingCopy, 4>{ "a", "b", "c", "d", "e" }), std::runtime_error);
+        ThrowingCopy::countdown = -1;
+        REQUIRE(ThrowingCopy::live == 11);
+    }
+}
+
+
+constexpr int inplaceSum() {
+    inplace_vector<int, 8> fake{5, 1, 4};
+    fake.push_back(2);
+    fake.insert(fake.begin() + 1, 2, 3);
+    fake.erase(fake.begin());
+    int sum = 0;
+    for (int x : fake)
+        sum += x;
+    return sum * 10 + int(fake.size());
+}
+
+TEST_CASE("22. Inplace vector") {
+    static_assert(inplaceSum() == 135, "usable in constant expressions");
+    static_assert(sizeof(inplace_vector<int, 8>) == sizeof(int[8]) + sizeof(size_t), "no overhead");
+    static_assert(std::is_trivially_copyable<inplace_vector<int, 8>>::value, "copied as bytes");
+
+    inplace_vector<std::string, 4> fake{"a", "b"};
+    std::vector<std::string> real{"a", "b"};
+
+    SECTION ("Same results as std::vector") {
+        fake.insert(fake.begin(), "x");
+        real.insert(real.begin(), "x");
+        fake.emplace(fake.begin() + 2, 1, 'y');
+        real.emplace(real.begin() + 2, 1, 'y');
+        fake.erase(fake.begin() + 1);
+        real.erase(real.begin() + 1);
+        fake.resize(4, "z");
+        real.resize(4, "z");
+
+        REQUIRE(fake.size() == real.size());
+        REQUIRE(std::equal(fake.begin(), fake.end(), real.begin()));
+    }
+    SECTION ("Capacity is never exceeded") {
+        fake.push_back("c");
+        fake.push_back("d");
+        REQUIRE_THROWS_AS(fake.push_back("e"), std::length_error);
+        REQUIRE_THROWS_AS(fake.insert(fake.begin(), "e"), std::length_error);
+        REQUIRE(fake.try_push_back("e") == nullptr);
+        REQUIRE(fake.size() == 4);
+
+        fake.pop_back();
+        REQUIRE(*fake.try_push_back("e") == "e");
+    }
+    SECTION ("Copy, swap and operators") {
+        inplace_vector<std::string, 4> copy(fake), other(3, "z");
+        REQUIRE(copy == fake);
+        copy.swap(other);
+        REQUIRE(other == fake);
+        REQUIRE(copy.size() == 3);
+        REQUIRE(fake < copy);
+        REQUIRE(copy >= fake);
+        REQUIRE(fake != copy);
+    }
+}
+
+
+TEST_CASE("23. Insert in place") {
+    vector<std::string> fake{"a", "b", "c"};
+    std::vector<std::string> real{"a", "b", "c"};
+    fake.reserve(10);
+    real.reserve(10);
+    const std::string* buffer = &fake[0];
+
+    for (int i = 0; i < 7; i ++) {
+        fake.insert(fake.begin() + i % 3, std::to_string(i));
+        real.insert(real.begin() + i % 3, std::to_string(i));
+    }
+    REQUIRE(&fake[0] == buffer);        // No reallocation while there is room
+    REQUIRE(fake.capacity() == 10);
+
+    fake.insert(fake.end(), "end");     // Both grow by the growth policy
+    real.insert(real.end(), "end");
+    fake.insert(fake.begin(), fake.back());
+    real.insert(real.begin(), real.back());
+
+    REQUIRE(fake.size() == real.size());
+    REQUIRE(fake.capacity() == real.capacity());
+    REQUIRE(std::equal(fake.begin(), fake.end(), real.begin()));
+    REQUIRE_THROWS_AS(fake.insert(fake.end() + 1, "x"), std::out_of_range);
+}
+
+
+TEST_CASE("24. Range insert and assign") {
+    std::list<std::string> words{"w1", "w2", "w3", "w4"};
+    vector<std::string> fake{"a", "b", "c"};
+    std::vector<std::string> real{"a", "b", "c"};
+
+    SECTION ("Insert a forward range") {
+        fake.insert(fake.begin() + 1, words.begin(), words.end());
+        real.insert(real.begin() + 1, words.begin(), words.end());
+        REQUIRE(fake.capacity() == 7);      // Grew once, to the exact size
+
+        fake.reserve(20);
+        fake.insert(fake.begin() + 2, words.begin(), words.end());  // In place
+        real.insert(real.begin() + 2, words.begin(), words.end());
+        fake.insert(fake.end(), {"x", "y"});
+        real.insert(real.end(), {"x", "y"});
+        fake.insert(fake.begin(), 2, fake[3]);
+        real.insert(real.begin(), 2, real[3]);
+
+        REQUIRE(fake.size() == real.size());
+        REQUIRE(fake.capacity() == 20);
+        REQUIRE(std::equal(fake.begin(), fake.end(), real.begin()));
+    }
+    SECTION ("Insert an input range") {
+        std::istringstream input("1 2 3 4 5");
+        vector<int> ints{10, 20};
+        ints.insert(ints.begin() + 1, std::istream_iterator<int>(input), std::istream_iterator<int>());
+        REQUIRE(ints == vector<int>{10, 1, 2, 3, 4, 5, 20});
+    }
+    SECTION ("Insert into a trivially relocatable vector") {
+        vector<int> ints(5, 1);
+        int more[] = {7, 8, 9};
+        ints.insert(ints.begin() + 2, more, more + 3);
+        ints.reserve(20);
+        ints.insert(ints.begin() + 1, more, more + 3);
+        ints.insert(ints.begin(), 3, 0);
+        REQUIRE(ints == vector<int>{0, 0, 0, 1, 7, 8, 9, 1, 7, 8, 9, 1, 1, 1});
+    }
+    SECTION ("Assign") {
+        fake.assign(words.begin(), words.end());    // Grows
+        real.assign(words.begin(), words.end());
+        REQUIRE(fake.capacity() == 4);
+        REQUIRE(std::equal(fake.begin(), fake.end(), real.begin()));
+
+        fake.assign({"p", "q"});                    // Shrinks in place
+        REQUIRE(fake.size() == 2);
+        REQUIRE(fake.capacity() == 4);
+        REQUIRE(fake[1] == "q");
+
+        std::istringstream input("r s t");
+        fake.assign(std::istream_iterator<std::string>(input), std::istream_iterator<std::string>());
+        REQUIRE(fake.size() == 3);
+        REQUIRE(fake.back() == "t");
+    }
+}
+
+
+TEST_CASE("25. Append") {
+    SECTION ("Grows once per batch") {
+        vector<int> fake{1, 2};
+        std::vector<int> batch(1000, 7);
+        fake.append(batch.begin(), batch.end());
+        REQUIRE(fake.size() == 1002);
+        REQUIRE(fake.capacity() == 1002);
+
+        fake.append_range(vector<int>{8, 9});
+        REQUIRE(fake.size() == 1004);
+        REQUIRE(fake.back() == 9);
+        REQUIRE(fake[1001] == 7);
+    }
+    SECTION ("Input range") {
+        std::istringstream input("3 4 5");
+        vector<int> fake{1, 2};
+        fake.append(std::istream_iterator<int>(input), std::istream_iterator<int>());
+        REQUIRE(fake == vector<int>{1, 2, 3, 4, 5});
+    }
+    SECTION ("Strong exception guarantee") {
+        vector<ThrowingCopy> fake{"a", "b"};
+        std::vector<ThrowingCopy> batch{"c", "d", "e"};
+        for (bool grow : {true, false}) {
+            if (!grow)
+                fake.reserve(10);
+            ThrowingCopy::countdown = 2;
+            REQUIRE_THROWS_AS(fake.append(batch.begin(), batch.end()), std::runtime_error);
+            ThrowingCopy::countdown = -1;
+            REQUIRE(fake.size() == 2);
+            REQUIRE(fake[1].value == "b");
+        }
+    }
+    SECTION ("Part of the vector itself") {
+        vector<int, remap_allocator<int>> remapped(300000, 1);
+        remapped.shrink_to_fit();
+        remapped.back() = 2;
+        remapped.append(remapped.begin(), remapped.end());
+        REQUIRE(remapped.size() == 600000);
+        REQUIRE(remapped[299999] == 2);
+        REQUIRE(remapped[300000] == 1);
+        REQUIRE(remapped.back() == 2);
+        remapped.shrink_to_fit();
+        remapped.append_range(remapped);
+        REQUIRE(remapped.size() == 1200000);
+        REQUIRE(std::count(remapped.begin(), remapped.end(), 2) == 4);
+
+        vector<std::string> strings{"a", "b"};
+        strings.shrink_to_fit();
+        strings.append(strings.begin(), strings.end());
+        REQUIRE(strings == vector<std::string>{"a", "b", "a", "b"});
+    }
+}
+
+
+TEST_CASE("26. Resize without initialization") {
+    vector<char> fake(4, 'a');
+
+    SECTION ("Default initialization") {
+        fake.resize_default_init(100);
+        REQUIRE(fake.size() == 100);
+        REQUIRE(fake[3] == 'a');
+        fake.resize_default_init(2);
+        REQUIRE(fake.size() == 2);
+
+        vector<std::string> strings{"a"};
+        strings.resize_default_init(3);     // Class types are still constructed
+        REQUIRE(strings[2].empty());
+    }
+    SECTION ("Overwrite") {
+        std::istringstream input("hello world");
+        fake.resize_and_overwrite(64, [&](char* buffer, size_t count) {
+            REQUIRE(buffer[0] == 'a');      // Old elements are kept
+            input.read(buffer + 4, count - 4);
+            return size_t(4 + input.gcount());
+        });
+        REQUIRE(fake.size() == 15);
+        REQUIRE(std::string(fake.begin(), fake.end()) == "aaaahello world");
+        REQUIRE_THROWS_AS(fake.resize_and_overwrite(2, [](char*, size_t) { return size_t(3); }), std::length_error);
+    }
+}
+
+TEST_CASE("27. Aligned storage") {
+    auto aligned = [](const void* p, size_t align) { return reinterpret_cast<uintptr_t>(p) % align == 0; };
+    aligned_vector<float, 64> fake(3, 1.5f);
+
+    REQUIRE(aligned(fake.data(), 64));
+    REQUIRE(fake.size() == 3);
+    REQUIRE(fake.capacity() == 16);     // One cache line of floats
+
+    SECTION ("Growth and shrinking") {
+        for (int i = 0; i < 100; ++i) {
+            fake.push_back(float(i));
+            REQUIRE(aligned(fake.data(), 64));
+            REQUIRE(fake.capacity() % 16 == 0);
+        }
+        fake.erase(fake.begin() + 10, fake.end());
+        fake.shrink_to_fit();
+        REQUIRE(aligned(fake.data(), 64));
+        REQUIRE(fake.capacity() == 16);
+        fake.reserve(1000);
+        REQUIRE(aligned(fake.data(), 64));
+        REQUIRE(fake.capacity() == 1008);
+        REQUIRE(fake[2] == 1.5f);
+        REQUIRE(fake[9] == 6.0f);
+        const aligned_vector<float, 64>& constant = fake;
+        REQUIRE(constant.data() == &fake[0]);
+    }
+    SECTION ("Copies and other element sizes") {
+        aligned_vector<float, 64> copy(fake);
+        REQUIRE(aligned(copy.data(), 64));
+        REQUIRE(copy == fake);
+
+        struct Triple { float x, y, z; };   // 12 bytes, 8 of them fill 3 AVX vectors
+        aligned_vector<Triple, 32> triples(5);
+        REQUIRE(aligned(triples.data(), 32));
+        REQUIRE(triples.capacity() == 8);
+
+        aligned_vector<std::string, 4096> strings{"a", "b"};
+        REQUIRE(aligned(strings.data(), 4096));
+        REQUIRE(strings.capacity() * sizeof(std::string) % 4096 == 0);
+    }
+}
+
+TEST_CASE("28. Comparison kernels") {
+    SECTION ("Integers") {
+        vector<int> a(1000, 7), b(1000, 7);
+        REQUIRE(a == b);
+        for (size_t i : {999, 500, 17, 0}) {
+            b[i] = 8;       // A mismatch at any offset of a SIMD block
+            REQUIRE(a != b);
+            REQUIRE(a < b);
+            REQUIRE(b > a);
+            REQUIRE(a <= b);
+            REQUIRE_FALSE(a >= b);
+        }
+        b[0] = -1;          // Ordered by value, not by bytes
+        REQUIRE(b < a);
+        b = a;
+        b.push_back(0);     // A prefix is less
+        REQUIRE(a < b);
+        REQUIRE(a <= b);
+        REQUIRE(vector<int>{} < b);
+    }
+    SECTION ("Bytes") {
+        vector<unsigned char> a(100, 'x'), b(100, 'x');
+        REQUIRE(a == b);
+        REQUIRE(a >= b);
+        b[70] = 200;
+        REQUIRE(a < b);
+        REQUIRE(b > a);
+        vector<signed char> c(40, 1), d(40, 1);
+        d[33] = -1;
+        REQUIRE(d < c);
+    }
+    SECTION ("Floating point") {
+        vector<double> a(50, 1.0), b(50, 1.0);
+        a[20] = 0.0;
+        b[20] = -0.0;       // Equal values with different bytes
+        REQUIRE(a == b);
+        REQUIRE(a <= b);
+        b[45] = 2.0;
+        REQUIRE(a < b);
+        vector<float> nan{ 1.0f, std::nanf("") };
+        REQUIRE(nan != nan);
+    }
+    SECTION ("Other types") {
+        vector<std::string> a{"apple", "pear"}, b{"apple", "plum"};
+        REQUIRE(a != b);
+        REQUIRE(a < b);
+        REQUIRE(b >= a);
+        small_vector<int, 4> c{1, 2, 3}, d{1, 2, 4};
+        REQUIRE(c < d);
+        REQUIRE(c != d);
+    }
+}
+
+TEST_CASE("29. Search") {
+    SECTION ("Integers of each size") {
+        vector<int32_t> a(1000);
+        vector<uint64_t> b(1000);
+        vector<char> c(1000, 'x');
+        vector<short> d(1000);
+        for (size_t i = 0; i < 1000; ++i) {
+            a[i] = int32_t(i);
+            b[i] = uint64_t(i) << 33;   // Differs from 0 only in the upper half
+            d[i] = short(i % 10);
+        }
+        for (size_t i : {0, 5, 63, 64, 500, 998, 999}) {   // Inside and outside SIMD blocks
+            REQUIRE(a.find(int32_t(i)) == a.begin() + i);
+            REQUIRE(a.index_of(int32_t(i)) == i);
+            REQUIRE(b.find(uint64_t(i) << 33) == b.begin() + i);
+        }
+        REQUIRE(a.find(-1) == a.end());
+        REQUIRE(a.index_of(1000) == vector<int32_t>::npos);
+        REQUIRE_FALSE(b.contains(1));
+        REQUIRE(b.count(0) == 1);
+        REQUIRE(d.count(3) == 100);
+        REQUIRE(c.count('x') == 1000);
+        c[777] = 'y';
+        REQUIRE(c.index_of('y') == 777);
+        REQUIRE(c.contains('y'));
+    }
+    SECTION ("Any of several values") {
+        vector<int> a(300, 0);
+        a[200] = 7;
+        a[250] = 9;
+        REQUIRE(a.find_any_of({9, 7}) == a.begin() + 200);
+        REQUIRE(a.find_any_of({5, 6}) == a.end());
+        REQUIRE(a.find_any_of({1, 2, 3, 4, 5, 6, 7, 8, 9, 10}) == a.begin() + 200);  // More values than
+        REQUIRE(a.find_any_of({1, 2, 3, 4, 5, 6, 8, 10, 11, 9}) == a.begin() + 250); // one SIMD pass takes
+        std::list<int> values{9, 8};
+        REQUIRE(a.find_any_of(values.begin(), values.end()) == a.begin() + 250);
+        *a.find_any_of({9}) = 1;
+        REQUIRE(a.count(1) == 1);
+    }
+    SECTION ("Floating point and other types") {
+        vector<double> a(20, 1.5);
+        a[17] = -0.0;
+        REQUIRE(a.index_of(0.0) == 17);     // Compared by value, not by bits
+        REQUIRE_FALSE(a.contains(std::nan("")));
+        vector<float> b{1, 2, 3};
+        REQUIRE(b.count(2.0f) == 1);
+
+        vector<std::string> c{"a", "b", "c"};
+        REQUIRE(c.index_of("c") == 2);
+        REQUIRE(c.find_any_of({"x", "b"}) == c.begin() + 1);
+        REQUIRE(vector<int>{}.find(0) == nullptr);
+    }
+}
+
+// Run the kernels of one element type against the std algorithms
+template <class T>
+void checkKernels(std::mt19937& generator) {
+    for (size_t sz : {0, 1, 7, 31, 64, 100, 1000}) {
+        vector<T> a(sz), b;
+        for (size_t i = 0; i < sz; ++i)
+            a[i] = T(generator() % 16);
+        b = a;
+        T value = T(generator() % 16), other = T(generator() % 16);
+        REQUIRE(a.find(value) == std::find(a.begin(), a.end(), value));
+        REQUIRE(a.count(value) == size_t(std::count(a.begin(), a.end(), value)));
+        T values[] = {value, other};
+        REQUIRE(a.find_any_of(values, values + 2) == std::find_first_of(a.begin(), a.end(), values, values + 2));
+        REQUIRE(a == b);
+        if (sz) {
+            b[generator() % sz] = T(20);
+            REQUIRE(a != b);
+            REQUIRE((a < b) == std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end()));
+        }
+    }
+}
+
+TEST_CASE("30. SIMD levels") {
+    simd::level initial = simd::active_level();
+    REQUIRE(initial <= simd::detect_level());
+    REQUIRE(simd::parse_level("avx2", simd::level::scalar) == simd::level::avx2);
+    REQUIRE(simd::parse_level("none", simd::level::sse2) == simd::level::sse2);
+
+    std::mt19937 generator(42);
+    for (int l = 0; l <= int(simd::detect_level()); ++l) {
+        simd::set_level(simd::level(l));
+        INFO("level " << simd::level_name(simd::level(l)));
+        REQUIRE(simd::active_level() == simd::level(l));
+        checkKernels<char>(generator);
+        checkKernels<unsigned char>(generator);
+        checkKernels<short>(generator);
+        checkKernels<int>(generator);
+        checkKernels<uint64_t>(generator);
+        checkKernels<float>(generator);
+        checkKernels<double>(generator);
+    }
+    simd::set_level(simd::level::avx512);   // Capped at what the CPU supports
+    REQUIRE(simd::active_level() == simd::detect_level());
+    simd::set_level(initial);
+}
+
+// Check the reductions of one element type against plain loops
+template <class T>
+void checkReductions(std::mt19937& generator) {
+    for (size_t sz : {1, 3, 16, 65, 1000, 5000}) {
+        vector<T> a(sz), b(sz);
+        for (size_t i = 0; i < sz; ++i) {
+            a[i] = T(int(generator() % 2001) - 1000) / T(8);
+            b[i] = T(int(generator() % 201) - 100);
+        }
+        double sum = 0, dot = 0;
+        for (size_t i = 0; i < sz; ++i) {
+            sum += a[i];
+            dot += double(a[i]) * b[i];
+        }
+        // Eighths of small integers are summed exactly in any order
+        REQUIRE(double(a.sum()) == sum);
+        REQUIRE(double(a.dot(b)) == dot);
+        REQUIRE(a.min() == *std::min_element(a.begin(), a.end()));
+        REQUIRE(a.max() == *std::max_element(a.begin(), a.end()));
+        REQUIRE(a.mean() == Approx(sum / sz));
+    }
+}
+
+TEST_CASE("31. Reductions") {
+    SECTION ("Every SIMD level") {
+        simd::level initial = simd::active_level();
+        std::mt19937 generator(7);
+        for (int l = 0; l <= int(simd::detect_level()); ++l) {
+            simd::set_level(simd::level(l));
+            INFO("level " << simd::level_name(simd::level(l)));
+            checkReductions<float>(generator);
+            checkReductions<double>(generator);
+            checkReductions<int>(generator);
+            checkReductions<short>(generator);
+            checkReductions<long long>(generator);
+        }
+        simd::set_level(initial);
+    }
+    SECTION ("Integer sums don't overflow") {
+        vector<int> a(100, INT_MAX);
+        REQUIRE(a.sum() == 100LL * INT_MAX);
+        vector<unsigned char> b(1000, 255);
+        REQUIRE(b.sum() == 255000u);
+        REQUIRE(b.minmax() == std::make_pair((unsigned char)255, (unsigned char)255));
+    }
+    SECTION ("Accurate floating point sums") {
+        vector<double> a(1000001, 1e-16);   // Each one is lost when added to 1
+        a[0] = 1.0;
+        REQUIRE(std::abs(a.sum() - (1 + 1e-10)) > 1e-12);
+        REQUIRE(std::abs(a.sum(simd::summation::kahan) - (1 + 1e-10)) < 1e-15);
+
+        vector<float> b(1 << 22, 0.1f);
+        double exact = double(0.1f) * b.size();
+        float naive = 0;
+        for (float x : b)
+            naive += x;
+        REQUIRE(std::abs(b.sum(simd::summation::pairwise) - exact) < std::abs(naive - exact) / 100);
+        REQUIRE(std::abs(b.sum(simd::summation::kahan) - exact) < 1);
+    }
+    SECTION ("Other types and errors") {
+        vector<std::string> a{"b", "a", "c"};
+        REQUIRE(a.sum() == "bac");
+        REQUIRE(a.minmax() == std::make_pair(std::string("a"), std::string("c")));
+        vector<int> empty;
+        REQUIRE(empty.sum() == 0);
+        REQUIRE_THROWS_AS(empty.min(), std::out_of_range);
+        REQUIRE_THROWS_AS(empty.mean(), std::out_of_range);
+        REQUIRE_THROWS_AS(empty.dot(vector<int>(1)), std::invalid_argument);
+    }
+}
+
+// Check expressions of one element type against plain loops
+template <class T>
+void checkExpressions(std::mt19937& generator) {
+    for (size_t sz : {1, 7, 16, 33, 100, 1000}) {   // With and without a tail past the last SIMD vector
+        vector<T> a(sz), b(sz), c(sz);
+        for (size_t i = 0; i < sz; ++i) {
+            a[i] = T(int(generator() % 201) - 100);
+            b[i] = T(int(generator() % 100) + 1);
+            c[i] = T(int(generator() % 21) - 10);
+        }
+        vector<T> r = a * b + c;
+        vector<T> q = (a - 3) / b;
+        vector<T> n = -abs(a) * 2;
+        vector<bool> m = expr::lazy(a) < c || !(expr::lazy(a) != b);
+        vector<T> w = where(a > 0 && expr::lazy(a) <= b, a, c);
+        vector<T> s = sqrt(b);
+        for (size_t i = 0; i < sz; ++i) {
+            REQUIRE(r[i] == T(a[i] * b[i] + c[i]));
+            REQUIRE(q[i] == T((a[i] - 3) / b[i]));
+            REQUIRE(n[i] == T(-std::abs(a[i]) * 2));
+            REQUIRE(m[i] == (a[i] < c[i] || a[i] == b[i]));
+            REQUIRE(w[i] == (a[i] > 0 && a[i] <= b[i] ? a[i] : c[i]));
+            REQUIRE(s[i] == T(std::sqrt(b[i])));
+        }
+        r = r - a * b;      // Reads what it writes
+        REQUIRE(r == c);
+        r *= 3;
+        r += c;
+        REQUIRE(r == vector<T>(c * 4));
+    }
+}
+
+// Tells whether x * y and x + y compile
+template <class X, class Y, class = void>
+struct combinable : std::false_type {};
+
+template <class X, class Y>
+struct combinable<X, Y, std::void_t<decltype(std::declval<const X&>() * std::declval<const Y&>()),
+                                    decltype(std::declval<const X&>() + std::declval<const Y&>())>> : std::true_type {};
+
+TEST_CASE("32. Expressions") {
+    SECTION ("Every SIMD level") {
+        simd::level initial = simd::active_level();
+        std::mt19937 generator(11);
+        for (int l = 0; l <= int(simd::detect_level()); ++l) {
+            simd::set_level(simd::level(l));
+            INFO("level " << simd::level_name(simd::level(l)));
+            checkExpressions<float>(generator);
+            checkExpressions<double>(generator);
+            checkExpressions<int>(generator);
+        }
+        simd::set_level(initial);
+    }
+    SECTION ("Evaluation into the destination") {
+        vector<double> a{1, 2, 3}, b{4, 5, 6}, r;
+        r.reserve(10);
+        const double* block = r.begin();
+        r = a * b + 1.5;
+        REQUIRE(r.begin() == block);    // No temporaries, no new block
+        REQUIRE(r == vector<double>{5.5, 11.5, 19.5});
+        vector<float> nan{1, std::nanf(""), 3};
+        vector<bool> same = expr::lazy(nan) == nan;
+        REQUIRE((same[0] && !same[1] && same[2]));
+    }
+    SECTION ("Errors") {
+        vector<float> a(3), b(4);
+        REQUIRE_THROWS_AS(a + b, std::invalid_argument);
+        REQUIRE_THROWS_AS(a = where(a < 1.0f, a, b), std::invalid_argument);
+        REQUIRE(a == vector<float>(3));
+        REQUIRE((a < b) == true);     // Plain vectors still compare as wholes
+    }
+    SECTION ("Numbers which would narrow are rejected") {
+        static_assert(combinable<vector<int>, int>::value, "ints");
+        static_assert(combinable<vector<int>, char>::value, "smaller integers");
+        static_assert(combinable<vector<float>, int>::value, "integer constants");
+        static_assert(combinable<vector<float>, float>::value, "floats");
+        static_assert(combinable<vector<double>, float>::value, "widening");
+        static_assert(combinable<double, vector<double>>::value, "number first");
+        static_assert(!combinable<vector<int>, double>::value, "0.5 would become 0");
+        static_assert(!combinable<double, vector<int>>::value, "number first");
+        static_assert(!combinable<vector<float>, double>::value, "1e40 would become inf");
+        static_assert(!combinable<vector<float>, long double>::value, "long double");
+        vector<float> a{1, 2};
+        vector<float> r = where(expr::lazy(a) < 1.5f, a, 0.5f);
+        REQUIRE(r == vector<float>{1, 0.5f});
+        vector<int> i = vector<int>{3, 4} * 2;
+        REQUIRE(i == vector<int>{6, 8});
+    }
+}
+
+// Element whose copies throw once *limit* copies were made, and which counts the live ones
+struct Fragile {
+    static std::atomic<int> live, copies, limit;
+    char payload[64] = {};
+    Fragile() { ++live; }
+    Fragile(const Fragile& other) {
+        if (++copies == limit)
+            throw std::runtime_error("copy");
+        std::memcpy(payload, other.payload, sizeof(payload));
+        ++live;
+    }
+    ~Fragile() { --live; }
+};
+std::atomic<int> Fragile::live{ 0 }, Fragile::copies{ 0 }, Fragile::limit{ -1 };
+
+TEST_CASE("33. Parallel construction") {
+    SECTION ("Thread pool") {
+        parallel::pool workers(3);
+        REQUIRE(workers.size() == 4);
+        std::atomic<size_t> sum{ 0 };
+        workers.run(1000, [&](size_t k) {
+            if (k % 100 == 0)   // Tasks may run tasks of their own
+                workers.run(10, [&](size_t j) { sum += j; });
+            sum += k;
+        });
+        REQUIRE(sum == 999 * 1000 / 2 + 10 * 45);
+        REQUIRE_THROWS_AS(workers.run(50, [](size_t k) { if (k == 17) throw std::runtime_error("task"); }), std::runtime_error);
+    }
+    SECTION ("Fill, copy and assign") {
+        parallel::policy four{ 4 };
+        vector<int> a(four, 1 << 20, 7);
+        REQUIRE(a.size() == 1 << 20);
+        REQUIRE(a.count(7) == a.size());
+        vector<int> b(parallel::par, a);
+        REQUIRE(b == a);
+        b.assign(parallel::policy{ 3 }, 3 << 20, 5);
+        REQUIRE(b.count(5) == 3 << 20);
+        b.assign(four, 1000, 6);
+        REQUIRE(b == vector<int>(1000, 6));
+
+        vector<std::string> words(200000);
+        for (size_t i = 0; i < words.size(); ++i)
+            words[i] = std::to_string(i) + " and a string too long for the small string buffer";
+        vector<std::string> copy(four, words);
+        REQUIRE(copy == words);
+    }
+    SECTION ("Cleanup after a throwing copy") {
+        {
+            vector<Fragile> source(40000);
+            Fragile::copies = 0;
+            Fragile::limit = 20000;     // In the middle of one of the chunks
+            REQUIRE_THROWS_AS(vector<Fragile>(parallel::policy{ 4 }, source), std::runtime_error);
+            REQUIRE(Fragile::live == 40000);
+            Fragile::copies = 0;
+            Fragile::limit = 3;
+            REQUIRE_THROWS_AS(vector<Fragile>(parallel::policy{ 4 }, 40000, source[0]), std::runtime_error);
+            REQUIRE(Fragile::live == 40000);
+            Fragile::limit = -1;
+        }
+        REQUIRE(Fragile::live == 0);
+    }
+}
+
+TEST_CASE("34. Parallel algorithms") {
+    parallel::pool workers(3);
+    parallel::policy four{ 4, &workers };
+    std::mt19937 random(34);
+    vector<int> numbers(1 << 20);
+    for (int& x : numbers)
+        x = int(random() % 100000) - 50000;
+    std::vector<int> expected(numbers.begin(), numbers.end());
+
+    SECTION ("Sort") {
+        std::sort(expected.begin(), expected.end());
+        for (parallel::policy p : { four, parallel::policy{ 3, &workers }, parallel::par, parallel::seq }) {
+            vector<int> sorted(numbers);
+            parallel::sort(p, sorted.begin(), sorted.end());
+            REQUIRE(std::equal(sorted.begin(), sorted.end(), expected.begin(), expected.end()));
+        }
+        vector<int> descending(numbers);
+        parallel::sort(four, descending.begin(), descending.end(), std::greater<>());
+        REQUIRE(std::equal(descending.begin(), descending.end(), expected.rbegin(), expected.rend()));
+
+        vector<std::string> words(100000);
+        for (size_t i = 0; i < words.size(); ++i)
+            words[i] = std::to_string(random()) + " and a string too long for the small string buffer";
+        std::vector<std::string> sortedWords(words.begin(), words.end());
+        std::sort(sortedWords.begin(), sortedWords.end());
+        parallel::sort(four, words.begin(), words.end());
+        REQUIRE(std::equal(words.begin(), words.end(), sortedWords.begin(), sortedWords.end()));
+    }
+    SECTION ("Stable sort") {
+        vector<std::pair<int, int>> pairs(1 << 18);     // Many equal keys, in the order of the second
+        for (size_t i = 0; i < pairs.size(); ++i)
+            pairs[i] = { int(random() % 1000), int(i) };
+        std::vector<std::pair<int, int>> stable(pairs.begin(), pairs.end());
+        auto byKey = [](const auto& a, const auto& b) { return a.first < b.first; };
+        std::stable_sort(stable.begin(), stable.end(), byKey);
+        parallel::stable_sort(four, pairs.begin(), pairs.end(), byKey);
+        REQUIRE(std::equal(pairs.begin(), pairs.end(), stable.begin(), stable.end()));
+    }
+    SECTION ("Transform and for_each") {
+        vector<long long> squares(numbers.size());
+        REQUIRE(parallel::transform(four, numbers.begin(), numbers.end(), squares.begin(),
+                                    [](int x) { return (long long)x * x; }) == squares.end());
+        vector<long long> sums(numbers.size());
+        parallel::transform(four, numbers.begin(), numbers.end(), squares.begin(), sums.begin(),
+                            [](int x, long long y) { return x + y; });
+        bool same = true;
+        for (size_t i = 0; i < numbers.size(); ++i)
+            same = same && squares[i] == (long long)numbers[i] * numbers[i] && sums[i] == numbers[i] + squares[i];
+        REQUIRE(same);
+        parallel::for_each(four, numbers.begin(), numbers.end(), [](int& x) { x += 1; });
+        REQUIRE(parallel::reduce(four, numbers.begin(), numbers.end(), 0LL)
+                == std::accumulate(expected.begin(), expected.end(), 0LL) + (long long)numbers.size());
+    }
+    SECTION ("Reduce and scan") {
+        long long total = std::accumulate(expected.begin(), expected.end(), 0LL);
+        REQUIRE(parallel::reduce(four, numbers.begin(), numbers.end(), 0LL) == total);
+        REQUIRE(parallel::reduce(parallel::par, numbers.begin(), numbers.end(), 5LL) == total + 5);
+        REQUIRE(parallel::reduce(four, numbers.begin(), numbers.end(), INT_MIN,
+                                 [](int a, int b) { return std::max(a, b); }) == *std::max_element(expected.begin(), expected.end()));
+        REQUIRE(parallel::reduce(four, numbers.begin(), numbers.begin(), 7LL) == 7);
+
+        std::partial_sum(expected.begin(), expected.end(), expected.begin());
+        vector<int> running(numbers.size());
+        REQUIRE(parallel::inclusive_scan(four, numbers.begin(), numbers.end(), running.begin()) == running.end());
+        REQUIRE(std::equal(running.begin(), running.end(), expected.begin(), expected.end()));
+        parallel::inclusive_scan(four, numbers.begin(), numbers.end(), numbers.begin());     // In place
+        REQUIRE(numbers == running);
+    }
+}
+
+TEST_CASE("35. Statistics") {
+    stats::counters before = stats::global();
+    {
+        vector<int> v;
+        for (int i = 0; i < 1000; ++i)
+            v.push_back(i);
+        stats::counters c = v.statistics();     // Capacities 1, 2, 4 ... 1024
+        REQUIRE(c.allocations == 11);
+        REQUIRE(c.deallocations == 10);
+        REQUIRE(c.reallocations == 10);
+        REQUIRE(c.bytes_relocated == 1023 * sizeof(int));
+        REQUIRE(c.bytes_held == 1024 * sizeof(int));
+        REQUIRE(c.peak_bytes_held == 1024 * sizeof(int));
+
+        v.reserve(5000);
+        v.shrink_to_fit();
+        c = v.statistics();
+        REQUIRE(c.reallocations == 12);
+        REQUIRE(c.bytes_relocated == (1023 + 2000) * sizeof(int));
+        REQUIRE(c.bytes_held == 1000 * sizeof(int));
+        REQUIRE(c.peak_bytes_held == 5000 * sizeof(int));
+
+        stats::counters all = stats::global();
+        REQUIRE(all.allocations - before.allocations == 13);
+        REQUIRE(all.bytes_held - before.bytes_held == 1000 * sizeof(int));
+        REQUIRE(all.peak_bytes_held >= before.bytes_held + 6024 * sizeof(int));   // Both blocks of the reserve
+
+        vector<int> moved(std::move(v));    // Counters stay with the objects, blocks move
+        REQUIRE(moved.statistics().allocations == 0);
+        REQUIRE(moved.statistics().bytes_held == 1000 * sizeof(int));
+        REQUIRE(v.statistics().bytes_held == 0);
+        moved.clear();
+        moved.shrink_to_fit();      // Released, not relocated
+        REQUIRE(moved.statistics().deallocations == 1);
+        REQUIRE(moved.statistics().reallocations == 0);
+
+        vector<int, remap_allocator<int>> remapped(10, 1);
+        remapped.reserve(100);      // Resized by the allocator, nothing copied by the vector
+        REQUIRE(remapped.statistics().allocations == 1);
+        REQUIRE(remapped.statistics().reallocations == 1);
+        REQUIRE(remapped.statistics().bytes_relocated == 0);
+        REQUIRE(remapped.statistics().bytes_held == 100 * sizeof(int));
+
+        std::ostringstream out;
+        stats::dump(out, remapped, "remapped");
+        REQUIRE(out.str() == "remapped: 10 of 100 elements used, 360 bytes unused; history: 1 allocations, "
+                             "0 deallocations, 1 reallocations, 0 bytes relocated, 400 bytes held (peak 400)\n");
+    }
+    stats::counters after = stats::global();
+    REQUIRE(after.allocations - before.allocations == after.deallocations - before.deallocations);
+    REQUIRE(after.bytes_held == before.bytes_held);
+    stats::reset();
+    REQUIRE(stats::global().allocations == 0);
+    REQUIRE(stats::global().peak_bytes_held == after.bytes_held);
+}
+
+// Counts its move constructions, so relocations can be told apart
+struct Counted {
+    static int moves;
+    int value;
+    Counted(int v = 0) : value(v) {}
+    Counted(const Counted& other) = default;
+    Counted(Counted&& other) noexcept : value(other.value) { ++moves; }
+    Counted& operator=(const Counted& other) = default;
+    Counted& operator=(Counted&& other) noexcept { value = other.value; return *this; }
+};
+int Counted::moves = 0;
+
+TEST_CASE("36. Incremental growth") {
+    SECTION ("Bounded moves per push_back") {
+        incremental_vector<Counted> v;
+        int most = 0;
+        bool migrated = false;
+        for (int i = 0; i < 100000; ++i) {
+            Counted::moves = 0;
+            v.push_back(Counted(i));    // One move of the argument itself
+            most = std::max(most, Counted::moves - 1);
+            migrated = migrated || v.migrating();
+        }
+        REQUIRE(most == int(incremental_vector<Counted>::moves_per_operation));
+        REQUIRE(migrated);
+        REQUIRE(v.capacity() == 131072);
+        bool inOrder = true;
+        for (int i = 0; i < 100000; ++i)
+            inOrder = inOrder && v[i].value == i;
+        REQUIRE(inOrder);
+    }
+    SECTION ("Operations during a migration") {
+        incremental_vector<std::string> v;
+        for (int i = 0; i < 1025; ++i)    // The last push starts moving 1024 elements
+            v.push_back(std::to_string(i) + " and a string too long for the small string buffer");
+        REQUIRE(v.migrating());
+        REQUIRE(v.capacity() == 2048);
+        REQUIRE(v.front().compare(0, 2, "0 ") == 0);
+        REQUIRE(v.back().compare(0, 5, "1024 ") == 0);
+        for (int i = 0; i < 10; ++i)
+            v.pop_back();       // Into the elements left in the old block
+        REQUIRE(v.size() == 1015);
+        REQUIRE(v.back().compare(0, 5, "1014 ") == 0);
+        REQUIRE(v.at(500).compare(0, 4, "500 ") == 0);
+        REQUIRE_THROWS_AS(v.at(1015), std::out_of_range);
+
+        incremental_vector<std::string> copy(v);
+        REQUIRE(!copy.migrating());
+        REQUIRE(copy == v);
+        std::sort(v.begin(), v.end(), std::greater<>());    // Iterators span both blocks
+        REQUIRE(v.migrating());
+        REQUIRE(v != copy);
+        REQUIRE(v > copy);
+        std::sort(v.begin(), v.end());
+        std::sort(copy.begin(), copy.end());
+        REQUIRE(v == copy);
+
+        v.insert(v.begin() + 5, "inserted");
+        REQUIRE(!v.migrating());
+        REQUIRE(v[5] == "inserted");
+        REQUIRE(v.size() == 1016);
+        v.erase(v.begin() + 5);
+        REQUIRE(v == copy);
+
+        incremental_vector<int> numbers;
+        for (int i = 0; i < 33; ++i)
+            numbers.push_back(i);
+        incremental_vector<int> moved(std::move(numbers));
+        REQUIRE(moved.migrating());
+        REQUIRE(numbers.empty());
+        REQUIRE(std::accumulate(moved.begin(), moved.end(), 0) == 32 * 33 / 2);
+        moved.clear();
+        REQUIRE(!moved.migrating());
+        REQUIRE(moved.capacity() == 64);
+        REQUIRE((incremental_vector<int>{ 1, 2, 3 } < incremental_vector<int>{ 1, 2, 4 }));
+    }
+    SECTION ("Constructors release what they built when a copy throws") {
+        ThrowingCopy value("x");
+        ThrowingCopy::countdown = 40;
+        REQUIRE_THROWS_AS((incremental_vector<ThrowingCopy>(100, value)), std::runtime_error);
+        REQUIRE(ThrowingCopy::live == 1);
+        incremental_vector<ThrowingCopy> fake(10, value);
+        ThrowingCopy::countdown = 6;
+        REQUIRE_THROWS_AS((incremental_vector<ThrowingCopy>(fake)), std::runtime_error);
+        ThrowingCopy::countdown = 3;
+        REQUIRE_THROWS_AS((incremental_vector<ThrowingCopy>{ "a", "b", "c", "d", "e" }), std::runtime_error);
+        ThrowingCopy::countdown = -1;
+        REQUIRE(ThrowingCopy::live == 11);
+    }
+}
+
+TEST_CASE("37. Segmented vector") {
+    SECTION ("Elements never move") {
+        segmented_vector<Counted> v;
+        v.push_back(Counted(0));
+        const Counted* first = &v[0];
+        Counted::moves = 0;
+        for (int i = 1; i < 100000; ++i)
+            v.emplace_back(i);
+        REQUIRE(Counted::moves == 0);
+        REQUIRE(&v[0] == first);
+        REQUIRE(v.capacity() >= v.size());
+        bool inOrder = true;
+        for (int i = 0; i < 100000; ++i)
+            inOrder = inOrder && v[i].value == i && &v.at(i) == &v[i];
+        REQUIRE(inOrder);
+        REQUIRE_THROWS_AS(v.at(100000), std::out_of_range);
+    }
+    SECTION ("Iterators walk across blocks") {
+        segmented_vector<int> v;
+        for (int i = 0; i < 10000; ++i)
+            v.push_back(i);
+        REQUIRE(std::accumulate(v.begin(), v.end(), 0LL) == 49995000LL);
+        REQUIRE(v.end() - v.begin() == 10000);
+        REQUIRE(*(v.begin() + 5000) == 5000);
+        REQUIRE(v.begin()[9999] == 9999);
+        REQUIRE(*v.rbegin() == 9999);
+        int expected = 9999;
+        bool backwards = true;
+        for (auto it = v.end(); it != v.begin(); )
+            backwards = backwards && *--it == expected--;
+        REQUIRE(backwards);
+        const segmented_vector<int>& c = v;
+        segmented_vector<int>::const_iterator it = v.begin();
+        REQUIRE(it == c.begin());
+        REQUIRE(std::is_sorted(c.begin(), c.end()));
+    }
+    SECTION ("Blocks are freed as the vector shrinks") {
+        segmented_vector<int> v;
+        v.reserve(100000);
+        size_t blocks = v.block_count();
+        const int* kept = &v.front();
+        v.resize(100000, 7);
+        REQUIRE(v.block_count() == blocks);
+        REQUIRE(&v.front() == kept);
+        while (v.size() > 10)
+            v.pop_back();
+        REQUIRE(v.block_count() <= 2);
+        REQUIRE(&v.front() == kept);
+        v.clear();
+        v.shrink_to_fit();
+        REQUIRE(v.block_count() == 0);
+        REQUIRE(v.capacity() == 0);
+        v.push_back(1);
+        REQUIRE(v.back() == 1);
+    }
+    SECTION ("Insert, erase and copies") {
+        segmented_vector<std::string> v{ "a", "b", "d" };
+        v.insert(v.begin() + 2, "c");
+        v.emplace(v.begin(), 3, 'z');
+        REQUIRE((v == segmented_vector<std::string>{ "zzz", "a", "b", "c", "d" }));
+        v.erase(v.begin());
+        v.erase(v.begin() + 1, v.begin() + 3);
+        REQUIRE((v == segmented_vector<std::string>{ "a", "d" }));
+        REQUIRE_THROWS_AS(v.erase(v.begin() + 1, v.begin()), std::invalid_argument);
+        segmented_vector<std::string> copy(v), moved(std::move(copy));
+        REQUIRE(copy.empty());
+        REQUIRE(moved == v);
+        copy = moved;
+        moved.push_back("e");
+        REQUIRE(copy != moved);
+        copy.swap(moved);
+        REQUIRE(copy.size() == 3);
+        segmented_vector<std::string> big(1000, "x");
+        big = std::move(copy);
+        REQUIRE(big.back() == "e");
+        big.assign(5, "y");
+        REQUIRE(big.size() == 5);
+        REQUIRE_THROWS_AS(big.resize(6), std::invalid_argument);
+    }
+    SECTION ("Comparisons") {
+        segmented_vector<int> a, b;
+        for (int i = 0; i < 5000; ++i) {
+            a.push_back(i);
+            b.push_back(i);
+        }
+        REQUIRE(a == b);
+        REQUIRE(a <= b);
+        b.back() = 5000;
+        REQUIRE(a != b);
+        REQUIRE(a < b);
+        b.pop_back();
+        REQUIRE(a > b);
+        REQUIRE(b < a);
+        REQUIRE(segmented_vector<int>{} < b);
+        REQUIRE(segmented_vector<int>{} == segmented_vector<int>{});
+        REQUIRE((segmented_vector<int>{ 1, 2, 3 } < segmented_vector<int>{ 1, 2, 4 }));
+        REQUIRE((segmented_vector<int>{ 2 } > segmented_vector<int>{ 1, 2, 4 }));
+#ifdef __cpp_lib_three_way_comparison
+        REQUIRE((a <=> b) == std::strong_ordering::greater);
+        REQUIRE((b <=> b) == std::strong_ordering::equal);
+        REQUIRE((segmented_vector<double>{ 1.0 } <=> segmented_vector<double>{ 1.0, 0.5 }) == std::partial_ordering::less);
+#endif
+    }
+    SECTION ("First block fills a cache line") {
+        struct Twelve { char bytes[12]; };
+        struct Three { char bytes[3]; };
+        static_assert(segmented_vector<Twelve>::first_block == 8, "96 bytes");
+        static_assert(segmented_vector<Three>::first_block == 32, "96 bytes");
+        static_assert(segmented_vector<int>::first_block == 16, "64 bytes");
+        static_assert(segmented_vector<char[100]>::first_block == 1, "one element");
+        REQUIRE(segmented_vector<Twelve>(1).capacity() == 8);
+    }
+    SECTION ("Constructors release what they built when a copy throws") {
+        ThrowingCopy value("x");
+        ThrowingCopy::countdown = 40;
+        REQUIRE_THROWS_AS((segmented_vector<ThrowingCopy>(100, value)), std::runtime_error);
+        REQUIRE(ThrowingCopy::live == 1);
+        segmented_vector<ThrowingCopy> fake(10, value);
+        ThrowingCopy::countdown = 6;
+        REQUIRE_THROWS_AS((segmented_vector<ThrowingCopy>(fake)), std::runtime_error);
+        ThrowingCopy::countdown = 3;
+        REQUIRE_THROWS_AS((segmented_vector<ThrowingCopy>{ "a", "b", "c", "d", "e" }), std::runtime_error);
+        ThrowingCopy::countdown = -1;
+        REQUIRE(ThrowingCopy::live == 11);
+    }
+}
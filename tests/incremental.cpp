@@ -0,0 +1,58 @@
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include "../incremental_vector.hpp"
+#include "timer.h"
+#include "histogram.h"
+
+const unsigned int pushCount = 50000000;
+
+// Element which counts how many times it was moved
+struct Tracked {
+    static size_t moves;
+    int value;
+    Tracked(int v) : value(v) {}
+    Tracked(const Tracked& other) : value(other.value) { ++moves; }
+    Tracked(Tracked&& other) noexcept : value(other.value) { ++moves; }
+};
+size_t Tracked::moves = 0;
+
+// Latency of each push_back of *pushCount* integers, and the most elements
+// one push_back of *pushCount* / 10 tracked elements relocated
+template <class Container, class TrackedContainer>
+void measure (const char* name) {
+    Histogram pushes;
+    Timer T;
+    T.set();
+    {
+        Container container;
+        for (unsigned int i = 0; i < pushCount; ++i)
+            pushes.record(elapsedNs([&] { container.push_back(int(i)); }));
+    }
+    double time = T.elapsed();
+    size_t most = 0;
+    {
+        TrackedContainer container;
+        for (unsigned int i = 0; i < pushCount / 10; ++i) {
+            Tracked element{ int(i) };
+            Tracked::moves = 0;
+            container.push_back(element);   // One copy of the element itself
+            most = std::max(most, Tracked::moves - 1);
+        }
+    }
+    std::cout << std::setw(24) << std::left << name << std::right << std::fixed << std::setprecision(3)
+              << std::setw(9) << time << "s" << std::setw(10) << pushes.percentile(50)
+              << std::setw(10) << pushes.percentile(99) << std::setw(10) << pushes.percentile(99.9)
+              << std::setw(12) << pushes.max() << std::setw(12) << most << "\n" << std::defaultfloat;
+}
+
+int main() {
+    std::cout << pushCount << " push_backs, latency in ns\n"
+              << std::setw(24) << std::left << "container" << std::right << std::setw(10) << "total"
+              << std::setw(10) << "p50" << std::setw(10) << "p99" << std::setw(10) << "p99.9"
+              << std::setw(12) << "max" << std::setw(12) << "max moved" << "\n";
+    measure<std::vector<int>, std::vector<Tracked>> ("std::vector<int>");
+    measure<vector<int>, vector<Tracked>> ("vector<int>");
+    measure<incremental_vector<int>, incremental_vector<Tracked>> ("incremental_vector<int>");
+    return 0;
+}
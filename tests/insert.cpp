@@ -0,0 +1,34 @@
+#include <vector>
+#include <iostream>
+#include <random>
+#include "../vector.hpp"
+#include "timer.h"
+
+// Insert *sz* integers at random positions, starting from an empty container
+template <class Container>
+void measure (unsigned int sz, const char* name) {
+    Container container;
+    std::mt19937 generator(42);
+    Timer T;
+    int reallocCount = 0;
+
+    std::cout << name << "\n";
+
+    T.set();
+    for (unsigned int i = 0; i < sz; ++i) {
+        if (container.size() == container.capacity())
+            reallocCount++;
+        size_t pos = std::uniform_int_distribution<size_t>(0, container.size())(generator);
+        container.insert(container.begin() + pos, int(i));
+    }
+    std::cout << "time: " << T.elapsed() << "s\n";
+    std::cout << "reallocated: " << reallocCount << " times\n";
+    std::cout << "reached capacity: " << container.capacity() << "\n\n";
+}
+
+int main() {
+    unsigned int sz = 100000;
+    measure<std::vector<int>> (sz, "std::vector");
+    measure<vector<int>> (sz, "vector");
+    return 0;
+}
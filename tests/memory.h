@@ -0,0 +1,17 @@
+#include <fstream>
+#include <string>
+
+// Peak resident set size of the process in kB, 0 if unknown
+inline long peakRss() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line))
+        if (line.compare(0, 6, "VmHWM:") == 0)
+            return std::stol(line.substr(6));
+    return 0;
+}
+
+// Start measuring the peak resident set size from the current value
+inline void resetPeakRss() {
+    std::ofstream("/proc/self/clear_refs") << "5";
+}
@@ -0,0 +1,79 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+#include <numeric>
+#include <random>
+#include <thread>
+#include "../vector.hpp"
+#include "timer.h"
+
+const size_t count = size_t(1) << 24;   // Doubles in the vectors, 128 MB
+
+// Seconds of one run of *algorithm* on a fresh copy of *source*
+template <class Algorithm>
+double measure (const vector<double>& source, vector<double>& target, Algorithm algorithm) {
+    target.assign(source.begin(), source.end());
+    Timer T;
+    T.set();
+    algorithm(target);
+    return T.elapsed();
+}
+
+// Times of the six algorithms: through std:: with *serial* set, else the parallel ones on *p*
+void measureAll (const vector<double>& source, parallel::policy p, bool serial, double* times) {
+    vector<double> target, out(source.size());
+    double total = 0;
+    auto square = [](double x) { return x * x; };
+    auto scale = [](double& x) { x = std::sqrt(std::abs(x)); };
+    if (serial) {
+        times[0] = measure(source, target, [](vector<double>& v) { std::sort(v.begin(), v.end()); });
+        times[1] = measure(source, target, [](vector<double>& v) { std::stable_sort(v.begin(), v.end()); });
+        times[2] = measure(source, target, [&](vector<double>& v) { std::transform(v.begin(), v.end(), out.begin(), square); });
+        times[3] = measure(source, target, [&](vector<double>& v) { total += std::accumulate(v.begin(), v.end(), 0.0); });
+        times[4] = measure(source, target, [&](vector<double>& v) { std::for_each(v.begin(), v.end(), scale); });
+        times[5] = measure(source, target, [&](vector<double>& v) { std::partial_sum(v.begin(), v.end(), out.begin()); });
+    } else {
+        times[0] = measure(source, target, [&](vector<double>& v) { parallel::sort(p, v.begin(), v.end()); });
+        times[1] = measure(source, target, [&](vector<double>& v) { parallel::stable_sort(p, v.begin(), v.end()); });
+        times[2] = measure(source, target, [&](vector<double>& v) { parallel::transform(p, v.begin(), v.end(), out.begin(), square); });
+        times[3] = measure(source, target, [&](vector<double>& v) { total += parallel::reduce(p, v.begin(), v.end(), 0.0); });
+        times[4] = measure(source, target, [&](vector<double>& v) { parallel::for_each(p, v.begin(), v.end(), scale); });
+        times[5] = measure(source, target, [&](vector<double>& v) { parallel::inclusive_scan(p, v.begin(), v.end(), out.begin()); });
+    }
+    if (std::isnan(total + out[out.size() / 2]))    // Keep the results in use
+        std::cout << "wrong result\n";
+}
+
+void print (const char* name, const double* times, const double* serial) {
+    std::cout << std::setw(8) << name << std::fixed << std::setprecision(3);
+    for (int i = 0; i < 6; ++i)
+        std::cout << std::setw(8) << times[i] << "s" << std::setprecision(2) << std::setw(5) << serial[i] / times[i] << "x"
+                  << std::setprecision(3);
+    std::cout << "\n" << std::defaultfloat;
+}
+
+int main() {
+    std::mt19937_64 random(21);
+    std::uniform_real_distribution<double> values(-1e6, 1e6);
+    vector<double> source(count);
+    for (double& x : source)
+        x = values(random);
+    unsigned hardware = std::max(std::thread::hardware_concurrency(), 1u);
+    std::cout << (count * sizeof(double) >> 20) << " MB of doubles, " << hardware << " hardware threads, "
+              << (parallel::l2_cache_bytes() >> 10) << " KB L2 cache; speedup over std::\n"
+              << std::setw(8) << "threads";
+    for (const char* name : { "sort", "stable", "transform", "reduce", "for_each", "scan" })
+        std::cout << std::setw(15) << name;
+    std::cout << "\n";
+    double serial[6], times[6];
+    measureAll(source, parallel::seq, true, serial);
+    print("std", serial, serial);
+    for (unsigned threads = 1; ; threads = std::min(threads * 2, hardware)) {
+        measureAll(source, parallel::policy{ threads }, false, times);
+        print(std::to_string(threads).c_str(), times, serial);
+        if (threads == hardware)
+            break;
+    }
+    return 0;
+}
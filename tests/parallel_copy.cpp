@@ -0,0 +1,51 @@
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include "../vector.hpp"
+#include "timer.h"
+
+const size_t totalBytes = size_t(1) << 30;  // Size of the vectors built
+
+struct Record {
+    long long id;
+    double values[6];
+    char tag[8];
+};
+
+// Seconds to build a vector with the given number of threads
+template <class Build>
+double measure (unsigned threads, Build build) {
+    Timer T;
+    T.set();
+    build(parallel::policy{ threads });
+    return T.elapsed();
+}
+
+int main() {
+    size_t count = totalBytes / sizeof(Record);
+    vector<Record> source(count, Record{ 1, { 2, 3, 4, 5, 6, 7 }, "record" });
+    vector<Record> target;
+    unsigned hardware = std::max(std::thread::hardware_concurrency(), 1u);
+    std::cout << (totalBytes >> 20) << " MB of " << sizeof(Record) << " byte records, "
+              << hardware << " hardware threads\n"
+              << std::setw(8) << "threads" << std::setw(12) << "copy" << std::setw(12) << "fill"
+              << std::setw(12) << "assign" << std::setw(12) << "speedup\n";
+    double serial = 0;
+    for (unsigned threads = 1; ; threads = std::min(threads * 2, hardware)) {
+        // The last vector is released outside the measurements
+        vector<Record>().swap(target);
+        double copy = measure(threads, [&](parallel::policy p) { vector<Record> v(p, source); target.swap(v); });
+        vector<Record>().swap(target);
+        double fill = measure(threads, [&](parallel::policy p) { vector<Record> v(p, count, source[0]); target.swap(v); });
+        // assign() overwrites the block the fill left
+        double assign = measure(threads, [&](parallel::policy p) { target.assign(p, count, source[1]); });
+        if (threads == 1)
+            serial = copy;
+        std::cout << std::setw(8) << threads << std::fixed << std::setprecision(3)
+                  << std::setw(11) << copy << "s" << std::setw(11) << fill << "s" << std::setw(11) << assign << "s"
+                  << std::setw(10) << std::setprecision(2) << serial / copy << "x\n" << std::defaultfloat;
+        if (threads == hardware)
+            break;
+    }
+    return 0;
+}
@@ -0,0 +1,65 @@
+#include <iostream>
+#include <memory_resource>
+#include <string>
+#include "../vector.hpp"
+#include "timer.h"
+
+const int requestCount = 100000;
+const int vectorsPerRequest = 32;
+
+// Work of a single request: dozens of short-lived vectors of ints and strings
+template <class IntVector, class StringVector, class... Resource>
+long long handle (int request, Resource*... resource) {
+    long long checksum = 0;
+    for (int v = 0; v < vectorsPerRequest; ++v) {
+        IntVector ints(resource...);
+        StringVector names(resource...);
+        int count = (request + v) % 64 + 1;
+        for (int i = 0; i < count; ++i) {
+            ints.push_back(i * v);
+            if (i % 8 == 0)
+                names.emplace_back("request scoped string, longer than SSO");
+        }
+        checksum += ints.back() + names.size();
+    }
+    return checksum;
+}
+
+void report (const char* name, Timer& T, long long checksum) {
+    std::cout << name << "\n";
+    std::cout << "time: " << T.elapsed() << "s (checksum " << checksum << ")\n\n";
+}
+
+int main() {
+    Timer T;
+    long long checksum = 0;
+
+    T.set();
+    for (int r = 0; r < requestCount; ++r)
+        checksum += handle<vector<int>, vector<std::string>>(r);
+    report("vector, default heap", T, checksum);
+
+    checksum = 0;
+    T.set();
+    for (int r = 0; r < requestCount; ++r)
+        checksum += handle<pmr::vector<int>, pmr::vector<std::pmr::string>>(r, std::pmr::new_delete_resource());
+    report("pmr::vector, new_delete_resource", T, checksum);
+
+    // Bump allocation, everything a request allocated is dropped at once
+    checksum = 0;
+    static char buffer[1 << 20];
+    T.set();
+    for (int r = 0; r < requestCount; ++r) {
+        std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer));
+        checksum += handle<pmr::vector<int>, pmr::vector<std::pmr::string>>(r, &arena);
+    }
+    report("pmr::vector, monotonic_buffer_resource", T, checksum);
+
+    checksum = 0;
+    std::pmr::unsynchronized_pool_resource pool;
+    T.set();
+    for (int r = 0; r < requestCount; ++r)
+        checksum += handle<pmr::vector<int>, pmr::vector<std::pmr::string>>(r, &pool);
+    report("pmr::vector, unsynchronized_pool_resource", T, checksum);
+    return 0;
+}
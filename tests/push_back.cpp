@@ -1,51 +1,121 @@
 #include <vector>
 #include <iostream>
+#include <iomanip>
+#include <random>
+#include <string>
 #include "../vector.hpp"
+#include "../remap_allocator.hpp"
 #include "timer.h"
+#include "memory.h"
+#include "histogram.h"
 
-void measure (unsigned int sz, bool std) {
-    std::vector<int> real;
-    vector<int> fake;
-    Timer T;
-    int reallocCount = 0, capacity;
-    bool didReallocate = false;
+template <class Container>
+void measure (unsigned int sz, const char* name, const typename Container::value_type& value) {
+    Container container;
+    Timer T, growthT;
+    int reallocCount = 0, capacity = 0;
+    double growthTime = 0;
 
-    std::cout << (std ? "std::vector\n" : "vector\n");
+    std::cout << name << "\n";
 
+    resetPeakRss();
     T.set();
-    if (std) {
-        for (int i = 1; i <= sz; ++i) {
-            if (real.size() == real.capacity()) {
-                reallocCount++; 
-                didReallocate = true;
-            }
-            real.push_back(i);
-            if (didReallocate) {
-                capacity = real.capacity();
-                didReallocate = false;
-            }
-        }
-    } else {
-        for (int i = 1; i <= sz; ++i) {
-        if (fake.size() == fake.capacity()) {
-            reallocCount++; 
-            didReallocate = true;
-        }
-        fake.push_back(i);
-        if (didReallocate) {
-            capacity = fake.capacity();
-            didReallocate = false;
-        }
-    }
+    for (unsigned int i = 1; i <= sz; ++i) {
+        if (container.size() == container.capacity()) {
+            reallocCount++;
+            growthT.set();
+            container.push_back(value);
+            growthTime += growthT.elapsed();    // Time of the push_backs which reallocated
+            capacity = container.capacity();
+        } else container.push_back(value);
     }
     std::cout << "time: " << T.elapsed() << "s\n";
+    std::cout << "growth time: " << growthTime << "s\n";
     std::cout << "reallocated: " << reallocCount << " times\n";
-    std::cout << "reached capacity: " << capacity << "\n\n";
+    std::cout << "reached capacity: " << capacity << "\n";
+    std::cout << "slack: " << 100.0 * (capacity - container.size()) / capacity << "%\n";
+    std::cout << "peak RSS: " << peakRss() / 1024 << " MB\n\n";
+}
+
+// Compare growth policies by time, reallocation count and unused capacity
+void measureGrowth (unsigned int sz) {
+    measure<vector<int, std::allocator<int>, grow_twice>> (sz, "grow_twice", 1);
+    measure<vector<int, std::allocator<int>, grow_one_and_half>> (sz, "grow_one_and_half", 1);
+    measure<vector<int, std::allocator<int>, grow_golden>> (sz, "grow_golden", 1);
+    measure<vector<int, std::allocator<int>, grow_page_rounded<>>> (sz, "grow_page_rounded", 1);
+    measure<vector<int, std::allocator<int>, grow_linear_above<64 << 20>>> (sz, "grow_linear_above<64 MB>", 1);
 }
 
-int main() {
+void printLatency (const char* name, const char* operation, const Histogram& h) {
+    std::cout << std::setw(30) << std::left << name << std::setw(10) << operation << std::right
+              << std::setw(10) << h.count() << std::setw(10) << h.percentile(50) << std::setw(10) << h.percentile(99)
+              << std::setw(10) << h.percentile(99.9) << std::setw(12) << h.max() << std::setw(10) << std::fixed
+              << std::setprecision(1) << h.mean() << "\n" << std::defaultfloat;
+}
+
+// Time each push_back, insert, erase and reserve on its own, so the ones
+// which relocate a large block show up in the tail instead of the average
+template <class Container>
+void measureLatency (const char* name) {
+    Histogram pushes, inserts, erases, reserves;
+    {
+        Container container;
+        for (unsigned int i = 0; i < 10000000; ++i)
+            pushes.record(elapsedNs([&] { container.push_back(int(i)); }));
+    }
+    {
+        Container container;
+        std::mt19937 generator(42);
+        for (unsigned int i = 0; i < 50000; ++i) {
+            size_t pos = std::uniform_int_distribution<size_t>(0, container.size())(generator);
+            inserts.record(elapsedNs([&] { container.insert(container.begin() + pos, int(i)); }));
+        }
+        while (!container.empty()) {
+            size_t pos = std::uniform_int_distribution<size_t>(0, container.size() - 1)(generator);
+            erases.record(elapsedNs([&] { container.erase(container.begin() + pos); }));
+        }
+    }
+    for (size_t sz = 1; sz <= (1 << 20); sz *= 2)     // Doubling full vectors of 1 to 1M elements
+        for (int r = 0; r < 16; ++r) {
+            Container container(sz, 1);
+            reserves.record(elapsedNs([&] { container.reserve(2 * sz); }));
+        }
+    printLatency(name, "push_back", pushes);
+    printLatency(name, "insert", inserts);
+    printLatency(name, "erase", erases);
+    printLatency(name, "reserve", reserves);
+}
+
+// Compare containers, growth policies and allocators by tail latency
+void measureLatencies () {
+    std::cout << std::setw(30) << std::left << "latency in ns" << std::setw(10) << "operation" << std::right
+              << std::setw(10) << "count" << std::setw(10) << "p50" << std::setw(10) << "p99"
+              << std::setw(10) << "p99.9" << std::setw(12) << "max" << std::setw(10) << "mean" << "\n";
+    measureLatency<std::vector<int>> ("std::vector<int>");
+    measureLatency<vector<int>> ("vector<int>");
+    measureLatency<vector<int, remap_allocator<int>>> ("vector<int, remap_allocator>");
+    measureLatency<vector<int, std::allocator<int>, grow_one_and_half>> ("grow_one_and_half");
+    measureLatency<vector<int, std::allocator<int>, grow_linear_above<4 << 20>>> ("grow_linear_above<4 MB>");
+}
+
+int main(int argc, char* argv[]) {
     unsigned int sz = 100000000;
-    measure (sz, true);
-    measure (sz, false);
+    if (argc > 1 && std::string(argv[1]) == "growth") {
+        measureGrowth(sz);
+        return 0;
+    }
+    if (argc > 1 && std::string(argv[1]) == "latency") {
+        measureLatencies();
+        return 0;
+    }
+    measure<std::vector<int>> (sz, "std::vector<int>", 1);
+    measure<vector<int>> (sz, "vector<int>", 1);
+    measure<vector<int, remap_allocator<int>>> (sz, "vector<int, remap_allocator>", 1);
+
+    // Strings longer than the small string buffer, so copying them allocates
+    unsigned int strSz = 10000000;
+    std::string str(32, 'x');
+    measure<std::vector<std::string>> (strSz, "std::vector<std::string>", str);
+    measure<vector<std::string>> (strSz, "vector<std::string>", str);
     return 0;
-}
\ No newline at end of file
+}
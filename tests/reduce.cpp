@@ -0,0 +1,87 @@
+#include <iostream>
+#include <iomanip>
+#include <cstdint>
+#include "../vector.hpp"
+#include "timer.h"
+
+const size_t totalBytes = size_t(4) << 30;  // Read by each measurement
+
+// Plain operator[] loops, as the reductions were written before
+template <class T>
+double naiveSum (const vector<T>& v) {
+    double s = 0;
+    for (size_t i = 0; i < v.size(); ++i)
+        s += v[i];
+    return s;
+}
+
+template <class T>
+double naiveMinmax (const vector<T>& v) {
+    T lo = v[0], hi = v[0];
+    for (size_t i = 1; i < v.size(); ++i) {
+        if (v[i] < lo) lo = v[i];
+        if (hi < v[i]) hi = v[i];
+    }
+    return double(hi) - double(lo);
+}
+
+template <class T>
+double naiveDot (const vector<T>& v) {
+    double s = 0;
+    for (size_t i = 0; i < v.size(); ++i)
+        s += double(v[i]) * double(v[i]);
+    return s;
+}
+
+// Reduce a vector of *bytes* bytes until *totalBytes* bytes are read,
+// returns the speed in GB/s
+template <class Value, class Reduce>
+double measure (size_t bytes, Reduce reduce) {
+    vector<Value> container(bytes / sizeof(Value));
+    for (size_t i = 0; i < container.size(); ++i)
+        container[i] = Value(i % 100);
+    size_t repeatCount = std::max(totalBytes / bytes, size_t(1));
+    double result = 0;
+    Timer T;
+    T.set();
+    for (size_t r = 0; r < repeatCount; ++r) {
+        container[r % container.size()] = Value(r % 100);  // Keep reduce() from being hoisted out of the loop
+        result += reduce(container);
+    }
+    double time = T.elapsed();
+    if (result == 42)   // Keep the loop from being optimized away
+        std::cout << "";
+    return double(repeatCount) * bytes / time / 1e9;
+}
+
+template <class T>
+void measureType (const char* name, bool floating) {
+    std::cout << name << " (GB/s)\n" << std::setw(10) << "size" << std::setw(12) << "[] sum" << std::setw(12) << "sum"
+              << std::setw(12) << "[] minmax" << std::setw(12) << "minmax" << std::setw(12) << "[] dot" << std::setw(12) << "dot";
+    if (floating)
+        std::cout << std::setw(12) << "pairwise" << std::setw(12) << "kahan";
+    std::cout << "\n";
+    // From L1 to far past the last level cache
+    for (size_t bytes : {size_t(16) << 10, size_t(256) << 10, size_t(4) << 20, size_t(256) << 20}) {
+        std::cout << std::setw(8) << (bytes >> 10) << "KB" << std::fixed << std::setprecision(2)
+                  << std::setw(12) << measure<T>(bytes, naiveSum<T>)
+                  << std::setw(12) << measure<T>(bytes, [](const vector<T>& v) { return double(v.sum()); })
+                  << std::setw(12) << measure<T>(bytes, naiveMinmax<T>)
+                  << std::setw(12) << measure<T>(bytes, [](const vector<T>& v) { auto m = v.minmax(); return double(m.second) - double(m.first); })
+                  << std::setw(12) << measure<T>(bytes, naiveDot<T>)
+                  << std::setw(12) << measure<T>(bytes, [](const vector<T>& v) { return double(v.dot(v)); });
+        if (floating)
+            std::cout << std::setw(12) << measure<T>(bytes, [](const vector<T>& v) { return double(v.sum(simd::summation::pairwise)); })
+                      << std::setw(12) << measure<T>(bytes, [](const vector<T>& v) { return double(v.sum(simd::summation::kahan)); });
+        std::cout << "\n" << std::defaultfloat;
+    }
+    std::cout << "\n";
+}
+
+int main() {
+    std::cout << "SIMD level: " << simd::level_name(simd::active_level()) << " (set VECTOR_SIMD_LEVEL to scalar, sse2, avx2 or avx512 to change it)\n\n";
+    measureType<double>("double", true);
+    measureType<float>("float", true);
+    measureType<int32_t>("int32_t", false);
+    return 0;
+}
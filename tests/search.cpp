@@ -0,0 +1,53 @@
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <iomanip>
+#include "../vector.hpp"
+#include "timer.h"
+
+const size_t totalBytes = size_t(4) << 30;  // Scanned by each measurement
+
+// Scan a vector of *bytes* bytes for a missing value until *totalBytes*
+// bytes are read, returns the speed in GB/s
+template <class Value, class Scan>
+double measure (size_t bytes, Scan scan) {
+    vector<Value> container(bytes / sizeof(Value));
+    for (size_t i = 0; i < container.size(); ++i)
+        container[i] = Value(i % 100);
+    size_t repeatCount = std::max(totalBytes / bytes, size_t(1)), hits = 0;
+    Timer T;
+    T.set();
+    for (size_t r = 0; r < repeatCount; ++r)
+        hits += scan(container, Value(100 + r % 2));
+    double time = T.elapsed();
+    if (hits == 42)     // Keep the loop from being optimized away
+        std::cout << "";
+    return double(repeatCount) * bytes / time / 1e9;
+}
+
+template <class T>
+void measureType (const char* name) {
+    std::cout << name << " (GB/s)\n" << std::setw(10) << "size" << std::setw(12) << "std::find"
+              << std::setw(12) << "find" << std::setw(12) << "std::count" << std::setw(12) << "count"
+              << std::setw(14) << "find_any_of\n";
+    // From L1 to far past the last level cache
+    for (size_t bytes : {size_t(16) << 10, size_t(256) << 10, size_t(4) << 20, size_t(256) << 20}) {
+        std::cout << std::setw(8) << (bytes >> 10) << "KB" << std::fixed << std::setprecision(2)
+                  << std::setw(12) << measure<T>(bytes, [](const vector<T>& v, T x) { return std::find(v.begin(), v.end(), x) - v.begin(); })
+                  << std::setw(12) << measure<T>(bytes, [](const vector<T>& v, T x) { return v.find(x) - v.begin(); })
+                  << std::setw(12) << measure<T>(bytes, [](const vector<T>& v, T x) { return std::count(v.begin(), v.end(), x); })
+                  << std::setw(12) << measure<T>(bytes, [](const vector<T>& v, T x) { return v.count(x); })
+                  << std::setw(13) << measure<T>(bytes, [](const vector<T>& v, T x) { return v.find_any_of({x, T(x + 2), T(x + 4)}) - v.begin(); })
+                  << "\n" << std::defaultfloat;
+    }
+    std::cout << "\n";
+}
+
+int main() {
+    std::cout << "SIMD level: " << simd::level_name(simd::active_level()) << " (set VECTOR_SIMD_LEVEL to scalar, sse2, avx2 or avx512 to change it)\n\n";
+    measureType<int32_t>("int32_t");
+    measureType<uint64_t>("uint64_t");
+    measureType<double>("double");
+    return 0;
+}
@@ -0,0 +1,61 @@
+#include <vector>
+#include <deque>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include "../vector.hpp"
+#include "../segmented_vector.hpp"
+#include "timer.h"
+
+const unsigned int pushCount = 100000000;
+const unsigned int lookupCount = 20000000;
+
+// Millions of push_backs a second, of sequential and of random reads
+// over *size* integers
+template <class Container>
+void measure (const char* name, unsigned int size, const std::vector<unsigned int>& indices) {
+    Timer T;
+    Container container;
+    T.set();
+    for (unsigned int i = 0; i < pushCount; ++i)
+        container.push_back(int(i));
+    double append = pushCount / T.elapsed() / 1e6;
+
+    while (container.size() > size)
+        container.pop_back();
+    long long sum = 0;
+    unsigned int reads = 0;
+    T.set();
+    for (; reads < lookupCount; reads += size)
+        for (auto it = container.begin(); it != container.end(); ++it)
+            sum += *it;
+    double sequential = reads / T.elapsed() / 1e6;
+
+    T.set();
+    for (unsigned int i : indices)
+        sum += container[i];
+    double random = indices.size() / T.elapsed() / 1e6;
+
+    std::cout << std::setw(24) << std::left << name << std::right << std::fixed << std::setprecision(0)
+              << std::setw(12) << append << std::setw(12) << sequential << std::setw(12) << random
+              << std::defaultfloat << "   (" << sum % 10 << ")\n";
+}
+
+int main() {
+    std::mt19937 gen(1);
+    for (unsigned int size : { 10000u, 1000000u, 100000000u }) {
+        std::uniform_int_distribution<unsigned int> position(0, size - 1);
+        std::vector<unsigned int> indices(lookupCount);
+        for (unsigned int& i : indices)
+            i = position(gen);
+        std::cout << pushCount << " push_backs, reads over " << size << " integers, millions a second\n"
+                  << std::setw(24) << std::left << "container" << std::right << std::setw(12) << "append"
+                  << std::setw(12) << "sequential" << std::setw(12) << "random" << "\n";
+        measure<std::vector<int>>("std::vector<int>", size, indices);
+        measure<vector<int>>("vector<int>", size, indices);
+        measure<std::deque<int>>("std::deque<int>", size, indices);
+        measure<segmented_vector<int>>("segmented_vector<int>", size, indices);
+        std::cout << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,38 @@
+#include <iostream>
+#include <iomanip>
+#include "../vector.hpp"
+#include "../small_vector.hpp"
+#include "timer.h"
+
+const int repeatCount = 1000000;
+
+// Build, read and destroy *repeatCount* vectors of *sz* integers
+template <class Container>
+double measure (int sz) {
+    Timer T;
+    long long checksum = 0;
+    T.set();
+    for (int r = 0; r < repeatCount; ++r) {
+        Container container;
+        for (int i = 0; i < sz; ++i)
+            container.push_back(i + r);
+        for (int x : container)
+            checksum += x;
+    }
+    double time = T.elapsed();
+    if (checksum == 42)     // Keep the loop from being optimized away
+        std::cout << "";
+    return time;
+}
+
+int main() {
+    std::cout << std::setw(6) << "size" << std::setw(14) << "vector"
+              << std::setw(18) << "small_vector<8>" << std::setw(19) << "small_vector<16>\n";
+    for (int sz : {0, 1, 2, 4, 8, 12, 16, 24, 32, 48, 64}) {
+        std::cout << std::setw(6) << sz
+                  << std::setw(13) << measure<vector<int>>(sz) << "s"
+                  << std::setw(17) << measure<small_vector<int, 8>>(sz) << "s"
+                  << std::setw(17) << measure<small_vector<int, 16>>(sz) << "s\n";
+    }
+    return 0;
+}
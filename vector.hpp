@@ -1,13 +1,184 @@
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <iterator>
 #include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#endif
+#if __has_include(<compare>)
+#include <compare>
+#endif
+#include "simd.hpp"
+#include "simd_reduce.hpp"
+#include "parallel.hpp"
+#include "vector_stats.hpp"
 
-template <class T> 
+// Tells whether moving an object to a new address and dropping the old one
+// without calling its destructor is the same as copying its bytes.
+// Types like unique_ptr wrappers may opt in by specializing it to std::true_type
+template <class T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+// Tells whether an allocator can resize a block bytewise with
+// a.reallocate(p, old_n, new_n), i.e. remap_allocator
+template <class Alloc, class = void>
+struct has_reallocate : std::false_type {};
+
+template <class Alloc>
+struct has_reallocate<Alloc, std::void_t<decltype(std::declval<Alloc&>().reallocate(
+    std::declval<typename Alloc::value_type*>(), std::size_t(), std::size_t()))>> : std::true_type {};
+
+// Tells whether an allocator constructs elements just like placement new,
+// so that the standard uninitialized algorithms and memcpy may be used instead
+template <class Alloc, class = void>
+struct has_default_construct : std::true_type {};
+
+template <class Alloc>
+struct has_default_construct<Alloc, std::void_t<decltype(std::declval<Alloc&>().construct(
+    std::declval<typename Alloc::value_type*>(), std::declval<const typename Alloc::value_type&>()))>>
+    : std::is_same<Alloc, std::allocator<typename Alloc::value_type>> {};
+
+// Alignment of the blocks an allocator returns, Alloc::alignment if it
+// declares one (i.e. aligned_allocator), alignof(value_type) otherwise
+template <class Alloc, class = void>
+struct allocation_alignment : std::integral_constant<std::size_t, alignof(typename Alloc::value_type)> {};
+
+template <class Alloc>
+struct allocation_alignment<Alloc, std::void_t<decltype(Alloc::alignment)>>
+    : std::integral_constant<std::size_t, Alloc::alignment> {};
+
+// Tells whether two objects are equal exactly when their bytes are, so
+// ranges of them may be compared with memcmp. Floats are not (-0 == 0),
+// nor are types with padding. Types may opt in by specializing it to std::true_type
+template <class T>
+struct is_trivially_comparable : std::integral_constant<bool,
+    std::is_integral<T>::value || std::is_enum<T>::value || std::is_pointer<T>::value> {};
+
+// Tells whether It is an iterator, so that a range isn't mistaken for (count, value)
+template <class It, class = void>
+struct is_iterator : std::false_type {};
+
+template <class It>
+struct is_iterator<It, std::void_t<typename std::iterator_traits<It>::iterator_category>> : std::true_type {};
+
+// Base of the lazy element-wise expressions of expression.hpp, which vectors
+// of numbers can be built from and assigned. They have value_type, size()
+// and evaluate(out), which writes all their elements to out
+struct vector_expression {};
+
+// Growth policies, chosen by the last template parameter of vector.
+// grow() returns the new capacity for a full vector which needs
+// room for at least *required* elements of *element_size* bytes
+
+// Multiply the capacity by Num / Den
+template <size_t Num, size_t Den>
+struct grow_by {
+    static_assert(Num > Den, "grow_by: the factor must be larger than 1");
+    static size_t grow( size_t capacity, size_t required, size_t ) {
+        return std::max(capacity + capacity / Den * (Num - Den) + capacity % Den * (Num - Den) / Den, required);
+    }
+};
+
+typedef grow_by<2, 1> grow_twice;
+typedef grow_by<3, 2> grow_one_and_half;
+typedef grow_by<1618, 1000> grow_golden;   // Freed blocks can be reused by later growths
+
+// Grow by Base, then round blocks larger than a page up to whole pages
+template <class Base = grow_twice, size_t PageSize = 4096>
+struct grow_page_rounded {
+    static size_t grow( size_t capacity, size_t required, size_t element_size ) {
+        size_t bytes = Base::grow(capacity, required, element_size) * element_size;
+        if (bytes > PageSize)
+            bytes = (bytes + PageSize - 1) / PageSize * PageSize;
+        return bytes / element_size;
+    }
+};
+
+// Grow by Below until the block reaches Bytes, then add Bytes at a time
+template <size_t Bytes, class Below = grow_twice>
+struct grow_linear_above {
+    static size_t grow( size_t capacity, size_t required, size_t element_size ) {
+        if (capacity * element_size < Bytes)
+            return std::min(Below::grow(capacity, required, element_size), 
+                            std::max(Bytes / element_size, required));
+        return std::max(capacity + std::max(Bytes / element_size, size_t(1)), required);
+    }
+};
+
+#ifdef __cpp_lib_three_way_comparison
+// Three-way compare two elements, through operator< if T has no operator<=>
+template <class T>
+constexpr auto synth_three_way( const T& a, const T& b ) {
+    if constexpr (std::three_way_comparable<T>)
+        return a <=> b;
+    else {
+        if (a < b)
+            return std::weak_ordering::less;
+        if (b < a)
+            return std::weak_ordering::greater;
+        return std::weak_ordering::equivalent;
+    }
+}
+#endif
+
+// Index of the first pair of elements of [a, a + n) and [b, b + n)
+// which are not equal, or *n*. Plain types are scanned by SIMD kernels
+template <class T>
+size_t mismatch_index( const T* a, const T* b, size_t n ) {
+    if constexpr (is_trivially_comparable<T>::value)
+        return simd::mismatch_bytes(a, b, n * sizeof(T)) / sizeof(T);
+    else if constexpr (std::is_same<T, float>::value || std::is_same<T, double>::value)
+        return simd::mismatch(a, b, n);
+    else return std::mismatch(a, a + n, b).first - a;
+}
+
+// Check if [a, a + n) and [b, b + n) hold equal elements
+template <class T>
+bool equal_elements( const T* a, const T* b, size_t n ) {
+    if constexpr (is_trivially_comparable<T>::value)
+        return n == 0 || std::memcmp(a, b, n * sizeof(T)) == 0;
+    else return mismatch_index(a, b, n) == n;
+}
+
+// Compare [a, a + n) and [b, b + m) lexicographically: a negative
+// result if the first range is less, positive if it's greater, else 0.
+// Elements which are neither less nor greater (i.e. NaN) count as equal
+template <class T>
+int compare_elements( const T* a, size_t n, const T* b, size_t m ) {
+    size_t common = std::min(n, m);
+    if constexpr (std::is_same<T, unsigned char>::value || std::is_same<T, std::byte>::value) {
+        if (int result = common ? std::memcmp(a, b, common) : 0)   // Same order as the bytes
+            return result;
+    } else {
+        size_t i = 0;
+        while ((i += mismatch_index(a + i, b + i, common - i)) < common) {
+            if (a[i] < b[i])
+                return -1;
+            if (b[i] < a[i])
+                return 1;
+            ++i;    // Unordered, i.e. NaN, look further
+        }
+    }
+    return n < m ? -1 : n > m;
+}
+
+inline namespace VECTOR_STATS_NAMESPACE {    // one per VECTOR_STATS setting, see vector_stats.hpp
+
+template <class T, class Allocator = std::allocator<T>, class Growth = grow_twice> 
 class vector {
     public:
         // Member types
         typedef T value_type;
-        typedef std::allocator<T> allocator_type;
+        typedef Allocator allocator_type;
+        typedef std::allocator_traits<Allocator> alloc_traits;
         typedef size_t size_type;
         typedef value_type& reference;
         typedef const value_type& const_reference;
@@ -15,341 +186,863 @@ class vector {
         typedef const T* const_iterator;
         typedef std::reverse_iterator<iterator> reverse_iterator;
         typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+        static constexpr size_type npos = size_type(-1);    // index_of() of a missing value
+        typedef simd::sum_t<T> sum_type;                    // sum() of integers is 64-bit
 
         // Member functions
-        vector() { create(); }
-        explicit vector(size_type n, const T& val = T{}) { create(n, val); }
-        vector(std::initializer_list<T> array); // Create from array
-        vector(const vector& v) { create(v.begin(), v.end()); } // copy
+        vector() noexcept(noexcept(Allocator())) : alloc() { create(); }
+        explicit vector(const Allocator& a) noexcept : alloc(a) { create(); }
+        explicit vector(size_type n, const T& val = T{}, const Allocator& a = Allocator())
+            : alloc(a) { create(n, val); }
+        vector(std::initializer_list<T> array, const Allocator& a = Allocator()) // Create from array
+            : alloc(a) { create(array.begin(), array.end()); }
+        vector(const vector& v)                 // copy
+            : alloc(alloc_traits::select_on_container_copy_construction(v.alloc)) { create(v.begin(), v.end()); }
+        vector(const vector& v, const Allocator& a) : alloc(a) { create(v.begin(), v.end()); }
+        vector(vector&& v) noexcept             // move
+            : start(v.start), avail(v.avail), limit(v.limit), alloc(std::move(v.alloc)) { v.create(); }
+        vector(vector&& v, const Allocator& a);
+        vector(parallel::policy p, size_type n, const T& val = T{}, const Allocator& a = Allocator())
+            : alloc(a) { create(n, val, p); }   // built by several threads, i.e. vector(parallel::par, n)
+        vector(parallel::policy p, const vector& v)
+            : alloc(alloc_traits::select_on_container_copy_construction(v.alloc)) { create(v.begin(), v.end(), p); }
+        template <class E, class = std::enable_if_t<std::is_base_of<vector_expression, E>::value>>
+        vector(const E& expression, const Allocator& a = Allocator())   // evaluate, i.e. b * c + d
+            : alloc(a) { create(); *this = expression; }
         ~vector() { uncreate(); }
         vector& operator=(const vector&);       // copy assignment
-        void assign( size_type count, const T& value );
+        vector& operator=(vector&&) noexcept(   // move assignment
+            alloc_traits::propagate_on_container_move_assignment::value || alloc_traits::is_always_equal::value);
+        template <class E, class = std::enable_if_t<std::is_base_of<vector_expression, E>::value>>
+        vector& operator=(const E& expression);
+        void assign( size_type count, const T& value ) { assign(parallel::seq, count, value); }
+        void assign( parallel::policy p, size_type count, const T& value );
+        template <class It, class = std::enable_if_t<is_iterator<It>::value>>
+        void assign( It first, It last );
+        void assign( std::initializer_list<T> array ) { assign(array.begin(), array.end()); }
         allocator_type get_allocator() const { return alloc; };
 
         // Element access
         reference at( size_type i );
         const_reference at( size_type i ) const;
-        T& operator[](size_type i) { return data[i]; }
-        const T& operator[](size_type i) const { return data[i]; }
-        reference front() { return *data; }
-        const_reference front() const { return *data; }
+        T& operator[](size_type i) { return start[i]; }
+        const T& operator[](size_type i) const { return start[i]; }
+        reference front() { return *start; }
+        const_reference front() const { return *start; }
         reference back() { return *(avail-1); }
         const_reference back() const { return *(avail-1); }
+        T* data() noexcept { return start; }
+        const T* data() const noexcept { return start; }
 
         // Iterators
-        iterator begin() noexcept { return data; }
-        const_iterator begin() const noexcept { return data; }
+        iterator begin() noexcept { return start; }
+        const_iterator begin() const noexcept { return start; }
         iterator end() noexcept { return avail; }
         const_iterator end() const noexcept { return avail; }
         reverse_iterator rbegin() noexcept { return reverse_iterator(avail); }
         const_reverse_iterator rbegin() const noexcept { return reverse_iterator(avail); };
-        reverse_iterator rend() noexcept { return reverse_iterator(data); }
-        const_reverse_iterator rend() const noexcept { return reverse_iterator(data); };
+        reverse_iterator rend() noexcept { return reverse_iterator(start); }
+        const_reverse_iterator rend() const noexcept { return reverse_iterator(start); };
 
         // Capacity
         bool empty() const { return (begin() == end()); }
-        size_type size() const { return avail - data; }
-        size_type capacity() const { return limit - data; }
+        size_type size() const { return avail - start; }
+        size_type capacity() const { return limit - start; }
         void reserve( size_type new_cap );
         void shrink_to_fit();
 
         // Modifiers
         void clear();
         iterator insert( const_iterator pos, const T& value );
-        iterator insert( const_iterator pos, int count, T& value);
+        iterator insert( const_iterator pos, size_type count, const T& value );
+        template <class It, class = std::enable_if_t<is_iterator<It>::value>>
+        iterator insert( const_iterator pos, It first, It last );
+        iterator insert( const_iterator pos, std::initializer_list<T> array ) 
+            { return insert(pos, array.begin(), array.end()); }
+        template <class... Args>
+        iterator emplace( const_iterator pos, Args&&... args );
         iterator erase( iterator pos );
         iterator erase( iterator first, iterator last );
         void push_back(const T& val);
+        void push_back(T&& val);
+        template <class It, class = std::enable_if_t<is_iterator<It>::value>>
+        void append( It first, It last );
+        template <class Range>
+        void append_range( Range&& range ) { append(std::begin(range), std::end(range)); }
+        template <class... Args>
+        reference emplace_back( Args&&... args );
         void pop_back();
         void resize( size_type count );
         void resize( size_type count, const value_type& value );
-        void swap( vector<T>& other ) noexcept;
+        void resize_default_init( size_type count );
+        template <class Operation>
+        void resize_and_overwrite( size_type count, Operation op );
+        void swap( vector<T, Allocator, Growth>& other ) noexcept(
+            alloc_traits::propagate_on_container_swap::value || alloc_traits::is_always_equal::value);
+
+        // Search
+        iterator find( const T& value ) { return start + (std::as_const(*this).find(value) - start); }
+        const_iterator find( const T& value ) const;
+        size_type count( const T& value ) const;
+        bool contains( const T& value ) const { return find(value) != avail; }
+        size_type index_of( const T& value ) const;
+        template <class It, class = std::enable_if_t<is_iterator<It>::value>>
+        iterator find_any_of( It first, It last ) { return start + (std::as_const(*this).find_any_of(first, last) - start); }
+        template <class It, class = std::enable_if_t<is_iterator<It>::value>>
+        const_iterator find_any_of( It first, It last ) const;
+        iterator find_any_of( std::initializer_list<T> values ) { return find_any_of(values.begin(), values.end()); }
+        const_iterator find_any_of( std::initializer_list<T> values ) const { return find_any_of(values.begin(), values.end()); }
+
+        // Reductions
+        sum_type sum( simd::summation mode = simd::summation::fast ) const;
+        double mean( simd::summation mode = simd::summation::fast ) const;
+        T min() const { return minmax().first; }
+        T max() const { return minmax().second; }
+        std::pair<T, T> minmax() const;
+        sum_type dot( const vector<T, Allocator, Growth>& other ) const;
+
+#if defined(VECTOR_STATS)
+        // Statistics
+        stats::counters statistics() const;     // blocks and bytes this vector used so far
+#endif
 
         // Operators
-        bool operator==(const vector<T>& other) const;
-        bool operator!=(const vector<T>& other) const;
-        bool operator<(const vector<T>& other) const;
-        bool operator>(const vector<T>& other) const;
-        bool operator>=(const vector<T>& other) const;
-        bool operator<=(const vector<T>& other) const;
+        bool operator==(const vector<T, Allocator, Growth>& other) const;
+#ifdef __cpp_lib_three_way_comparison
+        // !=, <, >, <= and >= are rewritten by the compiler in terms of these two
+        auto operator<=>(const vector<T, Allocator, Growth>& other) const;
+#else
+        bool operator!=(const vector<T, Allocator, Growth>& other) const;
+        bool operator<(const vector<T, Allocator, Growth>& other) const;
+        bool operator>(const vector<T, Allocator, Growth>& other) const;
+        bool operator>=(const vector<T, Allocator, Growth>& other) const;
+        bool operator<=(const vector<T, Allocator, Growth>& other) const;
+#endif
     private:    
-        iterator data;        // first element of the vector
+        iterator start;       // first element of the vector
         iterator avail;       // first element after the last vector element
         iterator limit;       // first element outside the reserved space
 
         allocator_type alloc;
+#if defined(VECTOR_STATS)
+        stats::counters usage;  // what the vector did with memory, bytes held aside
+#endif
 
+        iterator allocate(size_type);       // take a block from the allocator, counted in the statistics
+        void deallocate(iterator, size_type);   // give a block back
         void create();        // set pointers to null
-        void create(size_type, const T&);   // create a vec with copies of 'value'
-        void create(const_iterator, const_iterator); // create a vec with contents of a range
+        void create(size_type, const T&, parallel::policy = parallel::seq); // create a vec with copies of 'value'
+        template <class It>
+        void create(It, It, parallel::policy = parallel::seq);  // create a vec with contents of a range
         void uncreate();      // destroy the vec and deallocate space
-        void growTwice();     // increase the reserved space twice
-        void unchecked_append(const T&);    // Insert new element at the end
+        void destroy(iterator, iterator);   // destroy elements of a range backwards
+        void construct_fill(iterator, iterator, const T&, parallel::policy = parallel::seq);    // construct copies of 'value' in raw memory
+        template <class It>
+        iterator construct_copy(It, It, iterator, parallel::policy = parallel::seq);    // construct copies of a range in raw memory
+        void steal(vector&);  // take over the block of another vector
+        void grow();          // increase the reserved space by the growth policy
+        template <class... Args>
+        void grow_and_emplace(iterator, Args&&...); // grow a full vector, then insert a new element
+        template <class Fill>
+        void grow_with_gap(iterator, size_type, Fill);  // move to a larger block, filling a gap on the way
+        template <class Fill>
+        iterator insert_gap(iterator, size_type, Fill); // open a gap and fill it with new elements
+        void reallocate(size_type);         // move elements to a new block of given capacity
+        iterator relocate(iterator, iterator, iterator); // move a range to raw memory
+        static size_type padded(size_type); // round a capacity up to whole aligned chunks
 };
 
-// Create a vector from an array
-template <class T> 
-vector<T>::vector(std::initializer_list<T> array) {
-    data = alloc.allocate(array.size());
-    limit = avail = std::uninitialized_copy(array.begin(), array.end(), data);
 }
 
+#ifdef __cpp_lib_memory_resource
+// Vector which takes its memory from a std::pmr::memory_resource, i.e.
+//   std::pmr::monotonic_buffer_resource arena;
+//   pmr::vector<int> v(&arena);
+namespace pmr {
+    template <class T, class Growth = grow_twice>
+    using vector = ::vector<T, std::pmr::polymorphic_allocator<T>, Growth>;
+}
+#endif
+
+// Move a vector using another allocator. The block is taken over only
+// if the allocators are equal, otherwise the elements are moved one by one
+template <class T, class Allocator, class Growth> 
+vector<T, Allocator, Growth>::vector(vector&& v, const Allocator& a) : alloc(a) {
+    if (alloc == v.alloc) {
+        create();
+        steal(v);
+    } else {
+        create(std::make_move_iterator(v.begin()), std::make_move_iterator(v.end()));
+        v.clear();
+    }
+}
+
+// Take a block for *n* elements from the allocator
+template <class T, class Allocator, class Growth> 
+typename vector<T, Allocator, Growth>::iterator vector<T, Allocator, Growth>::allocate( size_type n ) {
+    iterator block = alloc_traits::allocate(alloc, n);
+    VECTOR_STATS_RECORD(stats::record_allocation(usage, n * sizeof(T)));
+    return block;
+}
+
+// Give the block of *n* elements at *block* back to the allocator
+template <class T, class Allocator, class Growth> 
+void vector<T, Allocator, Growth>::deallocate( iterator block, size_type n ) {
+    alloc_traits::deallocate(alloc, block, n);
+    VECTOR_STATS_RECORD(stats::record_deallocation(usage, n * sizeof(T)));
+}
+
+#if defined(VECTOR_STATS)
+// Counters of this vector object since it was built; its block may have
+// come from another vector by moving or swapping
+template <class T, class Allocator, class Growth> 
+stats::counters vector<T, Allocator, Growth>::statistics() const {
+    stats::counters c = usage;
+    c.bytes_held = capacity() * sizeof(T);
+    c.peak_bytes_held = std::max(c.peak_bytes_held, c.bytes_held);
+    return c;
+}
+#endif
+
 // Create an empty vector
-template <class T> 
-void vector<T>::create() {
-    data = avail = limit = nullptr;
+template <class T, class Allocator, class Growth> 
+void vector<T, Allocator, Growth>::create() {
+    start = avail = limit = nullptr;
 }
 
 // Create a vector with copies of 'value' or just reserved space
-template <class T> 
-void vector<T>::create(size_type n, const T& val) {
-    data = alloc.allocate(n); 
-    limit = avail = data + n;
-    std::uninitialized_fill(data, limit, val);
+template <class T, class Allocator, class Growth> 
+void vector<T, Allocator, Growth>::create(size_type n, const T& val, parallel::policy p) {
+    size_type cap = padded(n);
+    start = n ? allocate(cap) : nullptr; 
+    avail = start + n;
+    limit = start + (n ? cap : 0);
+    try {
+        construct_fill(start, avail, val, p);
+    } catch (...) {
+        deallocate(start, cap);
+        throw;
+    }
 }
 
 // Create a vector with contents of a range
-template <class T>
-void vector<T>::create(const_iterator i, const_iterator j) {    
-    data = alloc.allocate(j - i);
-    limit = avail = std::uninitialized_copy(i, j, data);
+template <class T, class Allocator, class Growth>
+template <class It>
+void vector<T, Allocator, Growth>::create(It i, It j, parallel::policy p) {
+    size_type n = std::distance(i, j);
+    size_type cap = padded(n);
+    start = n ? allocate(cap) : nullptr;
+    limit = start + (n ? cap : 0);
+    try {
+        avail = construct_copy(i, j, start, p);
+    } catch (...) {
+        deallocate(start, cap);
+        throw;
+    }
 }
 
 // Destroy the vector and deallocate space
-template <class T> 
-void vector<T>::uncreate() {
-    if (data) {
-        // Destroy elements backwards     
-        iterator it = avail;
-        while (it != data)
-            alloc.destroy(--it);      
-        alloc.deallocate(data, limit - data);    
+template <class T, class Allocator, class Growth> 
+void vector<T, Allocator, Growth>::uncreate() {
+    if (start) {
+        destroy(start, avail);
+        deallocate(start, limit - start);    
+        }
+    start = limit = avail = nullptr; // Reset pointers
+}
+
+// Destroy elements of range [first, last) backwards
+template <class T, class Allocator, class Growth> 
+void vector<T, Allocator, Growth>::destroy( iterator first, iterator last ) {
+    if constexpr (!std::is_trivially_destructible<T>::value)
+        while (last != first)
+            alloc_traits::destroy(alloc, --last);
+}
+
+// Construct copies of *value* in raw memory [first, last), in chunks on
+// several threads if *p* allows. Allocators with their own construct() fill serially
+template <class T, class Allocator, class Growth> 
+void vector<T, Allocator, Growth>::construct_fill( iterator first, iterator last, const T& value, parallel::policy p ) {
+    if constexpr (has_default_construct<Allocator>::value)
+        parallel::uninitialized_fill(p, first, last, value);
+    else {
+        iterator it = first;
+        try {
+            for (; it != last; ++it)
+                alloc_traits::construct(alloc, it, value);
+        } catch (...) {
+            destroy(first, it);     // Leave no half-built range behind
+            throw;
+        }
+    }
+}
+
+// Construct copies of range [first, last) in raw memory at dest, contiguous
+// ranges in chunks on several threads if *p* allows. Returns the end of the new range
+template <class T, class Allocator, class Growth> 
+template <class It>
+typename vector<T, Allocator, Growth>::iterator vector<T, Allocator, Growth>::construct_copy( It first, It last, iterator dest, parallel::policy p ) {
+    if constexpr (has_default_construct<Allocator>::value
+                  && std::is_pointer<It>::value && std::is_same<std::remove_cv_t<std::remove_pointer_t<It>>, T>::value)
+        return parallel::uninitialized_copy(p, first, last, dest);   // memcpy for plain bytes
+    else if constexpr (has_default_construct<Allocator>::value)
+        return std::uninitialized_copy(first, last, dest);
+    else {
+        iterator it = dest;
+        try {
+            for (; first != last; ++first, ++it)
+                alloc_traits::construct(alloc, it, *first);
+        } catch (...) {
+            destroy(dest, it);
+            throw;
         }
-    data = limit = avail = nullptr; // Reset pointers
+        return it;
+    }
+}
+
+// Take over the block of *other*, which is left empty
+template <class T, class Allocator, class Growth> 
+void vector<T, Allocator, Growth>::steal( vector& other ) {
+    start = other.start;
+    avail = other.avail;
+    limit = other.limit;
+    other.create();     // Leave other empty, but valid
+    VECTOR_STATS_RECORD(usage.peak_bytes_held = std::max(usage.peak_bytes_held, capacity() * sizeof(T)));
 }
 
 // Assignment operator
-template <class T> 
-vector<T>& vector<T>::operator=(const vector& rhs) {
+template <class T, class Allocator, class Growth> 
+vector<T, Allocator, Growth>& vector<T, Allocator, Growth>::operator=(const vector& rhs) {
     if (&rhs != this) {     
         uncreate();
+        if constexpr (alloc_traits::propagate_on_container_copy_assignment::value)
+            alloc = rhs.alloc;  // The old block was released with the old allocator
         create(rhs.begin(), rhs.end());
     }
     return *this;
 }
 
-// Increase the reserved space twice
-template <class T> 
-void vector<T>::growTwice() { 
-    size_type new_size = std::max((limit - data) * 2, ptrdiff_t(1));   
-    reserve(new_size);
+// Move assignment operator, steals the buffer of rhs if the allocators allow it
+template <class T, class Allocator, class Growth> 
+vector<T, Allocator, Growth>& vector<T, Allocator, Growth>::operator=(vector&& rhs) noexcept(
+    alloc_traits::propagate_on_container_move_assignment::value || alloc_traits::is_always_equal::value) {
+    if (&rhs != this) {
+        uncreate();
+        if constexpr (alloc_traits::propagate_on_container_move_assignment::value) {
+            alloc = std::move(rhs.alloc);
+            steal(rhs);
+        } else if (alloc_traits::is_always_equal::value || alloc == rhs.alloc)
+            steal(rhs);
+        else {  // This allocator can't free rhs's block, move the elements one by one
+            create(std::make_move_iterator(rhs.begin()), std::make_move_iterator(rhs.end()));
+            rhs.clear();
+        }
+    }
+    return *this;
 }
 
-// Insert new element at the end
-template <class T> 
-void vector<T>::unchecked_append(const T& val) {    
-    alloc.construct(avail++, val);
+// Increase the reserved space as the growth policy tells
+template <class T, class Allocator, class Growth> 
+void vector<T, Allocator, Growth>::grow() { 
+    reserve(Growth::grow(capacity(), size() + 1, sizeof(T)));
 }
 
 // Element access funtions
-template <class T>
-typename vector<T>::reference vector<T>::at( size_type i ) {
+template <class T, class Allocator, class Growth>
+typename vector<T, Allocator, Growth>::reference vector<T, Allocator, Growth>::at( size_type i ) {
     if (i < size() && i >= 0)
-        return data[i]; 
+        return start[i]; 
     else throw std::out_of_range {"vector::at"};
 }
 
-template <class T>
-typename vector<T>::const_reference vector<T>::at( size_type i ) const { 
+template <class T, class Allocator, class Growth>
+typename vector<T, Allocator, Growth>::const_reference vector<T, Allocator, Growth>::at( size_type i ) const { 
     if (i < size() && i >= 0) 
-        return data[i]; 
+        return start[i]; 
     else throw std::out_of_range {"vector::at"};
 }
 
-// Reallocate vector to a larger block of memory
-template <class T> 
-void vector<T>::reserve( size_type new_cap ) {
-    if (new_cap > capacity()) {
-        iterator new_data = alloc.allocate(new_cap);    
-        iterator new_avail = std::uninitialized_copy(data, avail, new_data);   
-        uncreate();
-        data = new_data;    
-        avail = new_avail;     
-        limit = data + new_cap;
+// Move the elements of range [first, last) to raw memory at dest and end
+// their lifetime at the old place. Returns the end of the new range
+template <class T, class Allocator, class Growth> 
+typename vector<T, Allocator, Growth>::iterator vector<T, Allocator, Growth>::relocate( iterator first, iterator last, iterator dest ) {
+    if constexpr (is_trivially_relocatable<T>::value) {
+        if (first != last)  // A single block copy, old objects need no destruction
+            std::memcpy(static_cast<void*>(dest), static_cast<const void*>(first), 
+                        (last - first) * sizeof(T));
+        return dest + (last - first);
+    } else {
+        iterator dest_last;
+        // Copy if moving could throw, so the old elements stay intact on failure
+        if constexpr (std::is_nothrow_move_constructible<T>::value || !std::is_copy_constructible<T>::value)
+            dest_last = construct_copy(std::make_move_iterator(first), std::make_move_iterator(last), dest);
+        else
+            dest_last = construct_copy(first, last, dest);
+        destroy(first, last);
+        return dest_last;
     }
 }
 
-// Release unused memory by the vector
-template <class T> 
-void vector<T>::shrink_to_fit() {
-    if (avail != limit) {
-        alloc.deallocate(avail, limit - avail);
-        limit = avail;
+// Move the vector to a new block of memory with *new_cap* capacity
+template <class T, class Allocator, class Growth> 
+void vector<T, Allocator, Growth>::reallocate( size_type new_cap ) {
+    new_cap = padded(new_cap);
+    if constexpr (has_reallocate<Allocator>::value && is_trivially_relocatable<T>::value) {
+        if (start && new_cap) {  // Let the allocator resize the block, in place if it can
+            size_type count = size();
+            VECTOR_STATS_RECORD(size_type old_cap = capacity();)
+            start = alloc.reallocate(start, limit - start, new_cap);
+            avail = start + count;
+            limit = start + new_cap;
+            VECTOR_STATS_RECORD(stats::record_resize(usage, old_cap * sizeof(T), new_cap * sizeof(T)));
+            return;
+        }
+    }
+    iterator new_data = new_cap ? allocate(new_cap) : nullptr;
+    iterator new_avail;
+    try {
+        new_avail = relocate(start, avail, new_data);
+    } catch (...) {
+        if (new_data)
+            deallocate(new_data, new_cap);
+        throw;
     }
+    // A first block, or none left for an emptied vector, isn't a relocation
+    VECTOR_STATS_RECORD(if (start && new_data) stats::record_relocation(usage, size() * sizeof(T)););
+    if (start)
+        deallocate(start, limit - start);
+    start = new_data;    
+    avail = new_avail;     
+    limit = start + new_cap;
+}
+
+// Round *n* up, so that the capacity ends on the allocator's alignment,
+// i.e. whole SIMD vectors. Without an aligned allocator it is left as it is
+template <class T, class Allocator, class Growth> 
+typename vector<T, Allocator, Growth>::size_type vector<T, Allocator, Growth>::padded( size_type n ) {
+    constexpr size_type step = allocation_alignment<Allocator>::value / std::gcd(allocation_alignment<Allocator>::value, sizeof(T));
+    return (n + step - 1) / step * step;
+}
+
+// Reallocate vector to a larger block of memory
+template <class T, class Allocator, class Growth> 
+void vector<T, Allocator, Growth>::reserve( size_type new_cap ) {
+    if (new_cap > capacity())
+        reallocate(new_cap);
 }
 
-// Replace the contents with *count* copies of *value* value
-template <class T> 
-void vector<T>::assign( size_type count, const T& value ) {
+// Evaluate an element-wise expression straight into the vector's block. The
+// expression may read the vector itself, i.e. v = v * 2 + 1
+template <class T, class Allocator, class Growth>
+template <class E, class>
+vector<T, Allocator, Growth>& vector<T, Allocator, Growth>::operator=(const E& expression) {
+    static_assert(std::is_arithmetic<T>::value, "vector: expressions are evaluated only into vectors of numbers");
+    static_assert(std::is_same<T, typename E::value_type>::value, "vector: the expression has another value type");
+    size_type n = expression.size();
+    if (n > capacity())
+        clear();    // Nothing to move to the new block, the vector can't be an operand of another size
+    resize_default_init(n);
+    expression.evaluate(start);
+    return *this;
+}
+
+// Release unused memory by the vector
+template <class T, class Allocator, class Growth> 
+void vector<T, Allocator, Growth>::shrink_to_fit() {
+    if (padded(size()) != capacity())
+        reallocate(size());
+}
+
+// Replace the contents with *count* copies of *value* value, built by
+// the threads *p* allows
+template <class T, class Allocator, class Growth> 
+void vector<T, Allocator, Growth>::assign( parallel::policy p, size_type count, const T& value ) {
     if (count < 1)
         throw std::invalid_argument{ "vector::assign" };
 
     if (count > capacity()) {
         uncreate();             // Erase all elements and deallocate memory
-        create(count, value);   // Create a new vector and fill it in
+        create(count, value, p);    // Create a new vector and fill it in
     } else {
-        iterator it = avail;
-        while (it != data)            
-            alloc.destroy(--it);// Erase all elements
-        
-        avail = data + count;   // Set new vector size
-        std::uninitialized_fill(data, avail, value); // Fill the vector with copies
+        destroy(start, avail);   // Erase all elements
+        avail = start;
+        construct_fill(start, start + count, value, p);  // Fill the vector with copies
+        avail = start + count;   // Set new vector size
+    }
+}
+
+// Replace the contents with copies of range [first, last), which may
+// not refer into the vector. A forward range is allocated for at most once
+template <class T, class Allocator, class Growth> 
+template <class It, class>
+void vector<T, Allocator, Growth>::assign( It first, It last ) {
+    if constexpr (std::is_base_of<std::forward_iterator_tag, typename std::iterator_traits<It>::iterator_category>::value) {
+        size_type count = std::distance(first, last);
+        if (count > capacity()) {
+            // Build the new contents in a new block, the old one stays intact on failure
+            size_type new_cap = padded(count);
+            iterator new_data = allocate(new_cap);
+            try {
+                construct_copy(first, last, new_data);
+            } catch (...) {
+                deallocate(new_data, new_cap);
+                throw;
+            }
+            uncreate();
+            start = new_data;
+            avail = start + count;
+            limit = start + new_cap;
+        } else if (count <= size()) {
+            iterator new_avail = std::copy(first, last, start);
+            destroy(new_avail, avail);
+            avail = new_avail;
+        } else {
+            It mid = std::next(first, size());
+            std::copy(first, mid, start);    // Overwrite the current elements, construct the rest
+            avail = construct_copy(mid, last, avail);
+        }
+    } else {
+        clear();
+        for (; first != last; ++first)
+            emplace_back(*first);
     }
 }
 
 // Delete all elements, don't deallocate space
-template <class T> 
-void vector<T>::clear() { 
-    iterator it = avail;
-    while (it != data)
-        alloc.destroy(--it);
-    avail = data;
+template <class T, class Allocator, class Growth> 
+void vector<T, Allocator, Growth>::clear() { 
+    destroy(start, avail);
+    avail = start;
 }
 
 // Insert *value* at *pos* position
-template <class T> 
-typename vector<T>::iterator vector<T>::insert( const_iterator pos, const T& value ) {
-    if (pos < data || pos >= avail)
+template <class T, class Allocator, class Growth> 
+typename vector<T, Allocator, Growth>::iterator vector<T, Allocator, Growth>::insert( const_iterator pos, const T& value ) {
+    if (pos < start || pos > avail)
         throw std::out_of_range{ "vector::insert" };
-    int pos_integer = 0;
-    for (iterator i = data; i < pos; i++)
-        pos_integer ++;
-
-    size_type new_size = size() + 1;
-    iterator new_data = alloc.allocate(new_size);
-    iterator new_avail = std::uninitialized_copy(data, avail + 1, new_data);
-
-    new_data[pos_integer] = value;
-    int after_pos = pos_integer + 1;
-    int new_last = size() + 1;
-
-    for (int i = after_pos; i < new_last; i++)
-        new_data[i] = data[i - 1];
-    
-    uncreate();
-    data = new_data;
-    avail = new_avail;
-    limit = data + new_size;
-
-    return data + pos_integer;
+    return emplace(pos, value);
 }
 
 // Insert *count* copies of *value* at *pos* position
-template <class T> 
-typename vector<T>::iterator vector<T>::insert( const_iterator pos, int count, T& value )
-{
-    if (pos < data || count < 1 || pos >= avail)
+template <class T, class Allocator, class Growth> 
+typename vector<T, Allocator, Growth>::iterator vector<T, Allocator, Growth>::insert( const_iterator pos, size_type count, const T& value ) {
+    if (pos < start || pos > avail)
+        throw std::out_of_range{ "vector::insert" };
+    T copy(value);              // value may be an element of this vector
+    return insert_gap(start + (pos - start), count, [&](iterator gap) { construct_fill(gap, gap + count, copy); });
+}
+
+// Insert copies of range [first, last) at *pos* position. The range may not
+// refer into the vector. A forward range is measured first, so the vector
+// grows at most once and the tail is moved only once
+template <class T, class Allocator, class Growth> 
+template <class It, class>
+typename vector<T, Allocator, Growth>::iterator vector<T, Allocator, Growth>::insert( const_iterator pos, It first, It last ) {
+    if (pos < start || pos > avail)
         throw std::out_of_range{ "vector::insert" };
-    avail += count;
-    int pos_integer = 0;
-    for (iterator i = data; i < pos; i++)
-        pos_integer ++;
-    size_type new_size = size() + count;
-    iterator new_data = alloc.allocate(new_size);
-    iterator new_avail = std::uninitialized_copy(data, avail, new_data);
-
-    for (int i = 0; i < pos_integer; i++)
-        new_data[i] = data[i];
-
-    for (int i = pos_integer; i <= pos_integer + count; i++)
-        new_data[i] = value;
-
-    int after_inserted = pos_integer + count;
-    int new_last = size() + count;
-    for (int i = after_inserted; i < new_last; i++) {
-        new_data[i] = data[i - count];
+    size_type offset = pos - start;
+    if constexpr (std::is_base_of<std::forward_iterator_tag, typename std::iterator_traits<It>::iterator_category>::value) {
+        size_type count = std::distance(first, last);
+        return insert_gap(start + offset, count, [&](iterator gap) { construct_copy(first, last, gap); });
+    } else {
+        // Length is unknown, append the elements, then rotate them into place
+        size_type old_size = size();
+        for (; first != last; ++first)
+            emplace_back(*first);
+        std::rotate(start + offset, start + old_size, avail);
+        return start + offset;
+    }
+}
+
+// Open a gap of *count* slots before *pos* and construct new elements in it by
+// calling fill(gap). Reallocates at most once, through the growth policy
+template <class T, class Allocator, class Growth> 
+template <class Fill>
+typename vector<T, Allocator, Growth>::iterator vector<T, Allocator, Growth>::insert_gap( iterator pos, size_type count, Fill fill ) {
+    size_type offset = pos - start;
+    if (count == 0)
+        return pos;
+    if (count > size_type(limit - avail)) {
+        if constexpr (has_reallocate<Allocator>::value && is_trivially_relocatable<T>::value)
+            reserve(Growth::grow(capacity(), size() + count, sizeof(T)));  // Block may be resized in place
+        else {
+            grow_with_gap(pos, count, fill);
+            return start + offset;
+        }
+    }
+    pos = start + offset;
+
+    if constexpr (is_trivially_relocatable<T>::value) {
+        // Slide the tail over as bytes, it leaves raw memory behind
+        size_type tail = avail - pos;
+        if (tail)
+            std::memmove(static_cast<void*>(pos + count), static_cast<const void*>(pos), tail * sizeof(T));
+        try {
+            fill(pos);
+        } catch (...) {
+            if (tail)
+                std::memmove(static_cast<void*>(pos), static_cast<const void*>(pos + count), tail * sizeof(T));
+            throw;
+        }
+        avail += count;
+    } else {
+        iterator old_avail = avail;
+        fill(avail);            // Build the elements at the end, then rotate them into place
+        avail += count;
+        std::rotate(pos, old_avail, avail);
+    }
+    return pos;
+}
+
+// Construct a new element in place before *pos* position
+template <class T, class Allocator, class Growth> 
+template <class... Args>
+typename vector<T, Allocator, Growth>::iterator vector<T, Allocator, Growth>::emplace( const_iterator pos, Args&&... args ) {
+    if (pos < start || pos > avail)
+        throw std::out_of_range{ "vector::emplace" };
+    size_type offset = pos - start;
+    if (avail == limit) {
+        grow_and_emplace(start + offset, std::forward<Args>(args)...);
+        return start + offset;
+    }
+    if (pos == avail) {
+        alloc_traits::construct(alloc, avail, std::forward<Args>(args)...);
+        ++avail;
+        return start + offset;
     }
-    uncreate();
-    data = new_data;
-    avail = new_avail;
-    limit = data + new_size;
 
-    return data + pos_integer;
+    T value(std::forward<Args>(args)...);   // args may refer to elements of this vector
+    iterator it = start + offset;
+    alloc_traits::construct(alloc, avail, std::move(*(avail - 1))); // Move the last element to raw space
+    ++avail;
+    std::move_backward(it, avail - 2, avail - 1);    // Shift the rest by one position
+    *it = std::move(value);
+    return it;
 }
 
 // Erase element at pos position
-template <class T> 
-typename vector<T>::iterator vector<T>::erase( iterator pos ) {
-    if (pos < data || pos >= avail)
+template <class T, class Allocator, class Growth> 
+typename vector<T, Allocator, Growth>::iterator vector<T, Allocator, Growth>::erase( iterator pos ) {
+    if (pos < start || pos >= avail)
         throw std::out_of_range{ "vector::erase" };
 
-    for (iterator i = pos; i < avail-1; i ++)
-        *i = *(i+1); // Move values by one position to the left
-
-    avail --;        // Reduce the vector size by one
+    std::move(pos + 1, avail, pos);  // Move values by one position to the left
+    alloc_traits::destroy(alloc, --avail); // Reduce the vector size by one
     return pos;
 }
 
 // Erase elements in a range
-template <class T> 
-typename vector<T>::iterator vector<T>::erase( iterator first, iterator last ) {
+template <class T, class Allocator, class Growth> 
+typename vector<T, Allocator, Growth>::iterator vector<T, Allocator, Growth>::erase( iterator first, iterator last ) {
     if (last < first)
         throw std::invalid_argument{ "vector::erase" };
-    if (first < data || last > avail)
+    if (first < start || last > avail)
         throw std::out_of_range{ "vector::erase" };
-    for (iterator i = first; i < avail-1; i ++)
-        *i = *(i+(last-first));
-    avail -= last - first;
-    return last;    
+    iterator new_avail = std::move(last, avail, first);
+    destroy(new_avail, avail);
+    avail = new_avail;
+    return first;
 }
 
 // Add an element to the back of the vector
-template <class T> 
-void vector<T>::push_back(const T& val){
-    if (avail == limit)        
-        growTwice();        // Increase the container capacity twice      
-    unchecked_append(val) ; // Insert new element at the end
+template <class T, class Allocator, class Growth> 
+void vector<T, Allocator, Growth>::push_back(const T& val){
+    emplace_back(val);
+}
+
+// Move an element to the back of the vector
+template <class T, class Allocator, class Growth> 
+void vector<T, Allocator, Growth>::push_back(T&& val){
+    emplace_back(std::move(val));
+}
+
+// Add copies of range [first, last) to the back of the vector, growing at
+// most once for a forward range. If a copy throws, the elements stay unchanged.
+// The range may be a part of the vector given by its iterators (pointers),
+// but not through other iterator types, i.e. reverse or move iterators
+template <class T, class Allocator, class Growth> 
+template <class It, class>
+void vector<T, Allocator, Growth>::append( It first, It last ) {
+    if constexpr (std::is_base_of<std::forward_iterator_tag, typename std::iterator_traits<It>::iterator_category>::value) {
+        size_type count = std::distance(first, last);
+        if constexpr (has_reallocate<Allocator>::value && is_trivially_relocatable<T>::value
+                      && std::is_pointer<It>::value && std::is_convertible<iterator, It>::value) {
+            // The allocator may move the block before the copies are made,
+            // so a range inside the vector is found again by its offset
+            std::less<const T*> before;
+            if (count > size_type(limit - avail) && !before(first, start) && before(first, avail)) {
+                size_type from = first - start;
+                reserve(Growth::grow(capacity(), size() + count, sizeof(T)));
+                first = start + from;
+                last = first + count;
+            }
+        }
+        insert_gap(avail, count, [&](iterator gap) { construct_copy(first, last, gap); });
+    } else {
+        size_type old_size = size();
+        try {
+            for (; first != last; ++first)
+                emplace_back(*first);
+        } catch (...) {
+            resize(old_size);   // Drop the part of the batch added so far
+            throw;
+        }
+    }
+}
+
+// Construct a new element in place at the end of the vector
+template <class T, class Allocator, class Growth> 
+template <class... Args>
+typename vector<T, Allocator, Growth>::reference vector<T, Allocator, Growth>::emplace_back( Args&&... args ) {
+    if (avail == limit)
+        grow_and_emplace(avail, std::forward<Args>(args)...);
+    else {
+        alloc_traits::construct(alloc, avail, std::forward<Args>(args)...);
+        ++avail;
+    }
+    return *(avail - 1);
+}
+
+// Move a full vector to a larger block and insert a new element before *pos*.
+// The element is built before the old block is released, as args may refer into it
+template <class T, class Allocator, class Growth> 
+template <class... Args>
+void vector<T, Allocator, Growth>::grow_and_emplace( iterator pos, Args&&... args ) {
+    if constexpr (has_reallocate<Allocator>::value && is_trivially_relocatable<T>::value) {
+        T value(std::forward<Args>(args)...);  // The allocator may move the block itself
+        size_type offset = pos - start;
+        grow();
+        emplace(start + offset, std::move(value));
+    } else
+        grow_with_gap(pos, 1, [&](iterator gap) { alloc_traits::construct(alloc, gap, std::forward<Args>(args)...); });
+}
+
+// Move the elements to a new block chosen by the growth policy, leaving a gap of
+// *count* raw slots before *pos*, which fill(gap) constructs. fill must clean up
+// after itself if it throws. Elements are moved only once, straight to their
+// new places; if anything throws the vector is left intact
+template <class T, class Allocator, class Growth> 
+template <class Fill>
+void vector<T, Allocator, Growth>::grow_with_gap( iterator pos, size_type count, Fill fill ) {
+    size_type old_size = size();
+    size_type new_cap = padded(Growth::grow(capacity(), old_size + count, sizeof(T)));
+    iterator new_data = allocate(new_cap);
+    iterator gap = new_data + (pos - start);
+    try {
+        fill(gap);
+        if constexpr (is_trivially_relocatable<T>::value || std::is_nothrow_move_constructible<T>::value
+                      || !std::is_copy_constructible<T>::value) {
+            relocate(start, pos, new_data);      // Elements before and after the gap
+            relocate(pos, avail, gap + count);
+        } else {
+            // Copy both parts before destroying anything, so a throwing copy leaves the vector intact
+            try {
+                construct_copy(start, pos, new_data);
+                try {
+                    construct_copy(pos, avail, gap + count);
+                } catch (...) {
+                    destroy(new_data, gap);
+                    throw;
+                }
+            } catch (...) {
+                destroy(gap, gap + count);
+                throw;
+            }
+            destroy(start, avail);
+        }
+    } catch (...) {
+        deallocate(new_data, new_cap);
+        throw;
+    }
+    VECTOR_STATS_RECORD(if (start) stats::record_relocation(usage, old_size * sizeof(T)););
+    if (start)
+        deallocate(start, limit - start);
+    start = new_data;
+    avail = new_data + old_size + count;
+    limit = start + new_cap;
 }
 
 // Delete the last element of the vector
-template <class T> 
-void vector<T>::pop_back(){
-    iterator it = avail;           
-    alloc.destroy(--it);
+template <class T, class Allocator, class Growth> 
+void vector<T, Allocator, Growth>::pop_back(){
+    alloc_traits::destroy(alloc, avail - 1);
     avail--;
 }
 
 // Leave the vector with *count* elements only (count<size)
-template <class T> 
-void vector<T>::resize( size_type count ) {
+template <class T, class Allocator, class Growth> 
+void vector<T, Allocator, Growth>::resize( size_type count ) {
     if (count < 0 || count > size())
         throw std::invalid_argument{ "vector::resize" };
-    while (begin() + count != avail)
-        alloc.destroy(--avail);
+    destroy(start + count, avail);
+    avail = start + count;
 }
 
 // If the current size is less than count, additional elements are 
 // appended and initialized with copies of value
-template <class T>
-void vector<T>::resize( size_type count, const value_type& value ) {
+template <class T, class Allocator, class Growth>
+void vector<T, Allocator, Growth>::resize( size_type count, const value_type& value ) {
     if (count < 0)
         throw std::invalid_argument{ "vector::resize" };
     if (size() > count)
         resize(count);
     else {
-        if (limit == avail)
-            reserve(size() + (count - size()));
-        std::uninitialized_fill(avail, limit, value);
-        avail = limit;
+        reserve(count);
+        construct_fill(avail, start + count, value);
+        avail = start + count;
     }
 }
 
+// Resize to *count* elements, new elements are default-initialized:
+// for trivial types their memory is left as it is, without being zeroed
+template <class T, class Allocator, class Growth>
+void vector<T, Allocator, Growth>::resize_default_init( size_type count ) {
+    if (size() > count)
+        resize(count);
+    else {
+        reserve(count);
+        iterator new_avail = start + count;
+        if constexpr (has_default_construct<Allocator>::value)
+            std::uninitialized_default_construct(avail, new_avail);
+        else {  // The allocator decides how elements are built
+            iterator it = avail;
+            try {
+                for (; it != new_avail; ++it)
+                    alloc_traits::construct(alloc, it);
+            } catch (...) {
+                destroy(avail, it);
+                throw;
+            }
+        }
+        avail = new_avail;
+    }
+}
+
+// Let op(data, count) write up to *count* elements straight into the
+// reserved memory and return how many it wrote, i.e. from read(). Only for
+// trivial types, elements past the current size are not initialized before
+template <class T, class Allocator, class Growth>
+template <class Operation>
+void vector<T, Allocator, Growth>::resize_and_overwrite( size_type count, Operation op ) {
+    static_assert(std::is_trivial<T>::value, "vector::resize_and_overwrite: T must be trivial");
+    reserve(count);
+    size_type new_size = std::move(op)(start, count);
+    if (new_size > count)
+        throw std::length_error{ "vector::resize_and_overwrite" };
+    avail = start + new_size;
+}
+
 // Exchange the contents of the container with those of other
-template <class T>
-void vector<T>::swap( vector<T>& other ) noexcept {
-    iterator temp = data;
-    data = other.data;
-    other.data = temp;
+template <class T, class Allocator, class Growth>
+void vector<T, Allocator, Growth>::swap( vector<T, Allocator, Growth>& other ) noexcept(
+    alloc_traits::propagate_on_container_swap::value || alloc_traits::is_always_equal::value) {
+    // Blocks may change owners only if allocators go along with them or are equal
+    if constexpr (alloc_traits::propagate_on_container_swap::value)
+        std::swap(alloc, other.alloc);
+
+    iterator temp = start;
+    start = other.start;
+    other.start = temp;
 
     temp = avail;
     avail = other.avail;
@@ -358,62 +1051,135 @@ void vector<T>::swap( vector<T>& other ) noexcept {
     temp = limit;
     limit = other.limit;
     other.limit = temp;
+    VECTOR_STATS_RECORD(usage.peak_bytes_held = std::max(usage.peak_bytes_held, capacity() * sizeof(T));
+                        other.usage.peak_bytes_held = std::max(other.usage.peak_bytes_held, other.capacity() * sizeof(T)));
 }
 
-// Check if both vectors have the same size and values
-template <class T>
-bool vector<T>::operator==(const vector<T>& other) const {
-    if (size() == other.size()) {
-        for (int i = 0; i < size(); i ++)
-            if (at(i) != other.at(i))   // Search for any mismatch
-                return false;           // Return breaks the loop
-        return true;
-    } else return false;
+// Find the first element equal to *value*, or end(). Integers and
+// floating point numbers are compared many at a time by the SIMD kernels
+template <class T, class Allocator, class Growth>
+typename vector<T, Allocator, Growth>::const_iterator vector<T, Allocator, Growth>::find( const T& value ) const {
+    if constexpr (simd::is_searchable<T>::value)
+        return start + simd::find(start, size(), value);
+    else return std::find(start, avail, value);
 }
 
-template <class T>
-bool vector<T>::operator!=(const vector<T>& other) const {
-    // Use the already implemented == operator
-    return *this == other ? false : true;
+// Count the elements equal to *value*
+template <class T, class Allocator, class Growth>
+typename vector<T, Allocator, Growth>::size_type vector<T, Allocator, Growth>::count( const T& value ) const {
+    if constexpr (simd::is_searchable<T>::value)
+        return simd::count(start, size(), value);
+    else return std::count(start, avail, value);
 }
 
-// Compare vectors lexicographically
-template <class T>
-bool vector<T>::operator<(const vector<T>& other) const {
-    size_type smaller_size;
-    if (size() < other.size())
-        smaller_size = size();
-    else smaller_size = other.size();
+// Position of the first element equal to *value*, or npos
+template <class T, class Allocator, class Growth>
+typename vector<T, Allocator, Growth>::size_type vector<T, Allocator, Growth>::index_of( const T& value ) const {
+    const_iterator it = find(value);
+    return it != avail ? size_type(it - start) : npos;
+}
+
+// Find the first element equal to any of [first, last), or end()
+template <class T, class Allocator, class Growth>
+template <class It, class>
+typename vector<T, Allocator, Growth>::const_iterator vector<T, Allocator, Growth>::find_any_of( It first, It last ) const {
+    if constexpr (!simd::is_searchable<T>::value)
+        return std::find_first_of(start, avail, first, last);
+    else if constexpr (std::is_convertible<It, const T*>::value)
+        return start + simd::find_any_of(start, size(), static_cast<const T*>(first), size_type(last - first));
+    else {  // The kernels need the values in one block
+        vector<T> values;
+        values.append(first, last);
+        return start + simd::find_any_of(start, size(), values.begin(), values.size());
+    }
+}
 
-    for (size_type i = 0; i < smaller_size; i++)
-        if (at(i) != other[i])       // Find the first mismatching element
-            return at(i) < other[i];
-    // If one range is a prefix of another, the shorter range is 
-    // lexicographically less than the other
-    return size() < other.size();
+// Sum of the elements, see simd::summation for the modes of floating point sums
+template <class T, class Allocator, class Growth>
+typename vector<T, Allocator, Growth>::sum_type vector<T, Allocator, Growth>::sum( simd::summation mode ) const {
+    if constexpr (std::is_arithmetic<T>::value)
+        return simd::sum(start, size(), mode);
+    else return std::accumulate(start, avail, T{});
 }
 
-template <class T>
-bool vector<T>::operator>(const vector<T>& other) const {
-    size_type smaller_size;
-    if (size() < other.size())
-        smaller_size = size();
-    else smaller_size = other.size();
+// Average of the elements
+template <class T, class Allocator, class Growth>
+double vector<T, Allocator, Growth>::mean( simd::summation mode ) const {
+    static_assert(std::is_arithmetic<T>::value, "vector::mean: T must be a number");
+    if (empty())
+        throw std::out_of_range{ "vector::mean" };
+    return double(sum(mode)) / double(size());
+}
+
+// Smallest and largest elements, found in one pass
+template <class T, class Allocator, class Growth>
+std::pair<T, T> vector<T, Allocator, Growth>::minmax() const {
+    if (empty())
+        throw std::out_of_range{ "vector::minmax" };
+    if constexpr (std::is_arithmetic<T>::value)
+        return simd::minmax(start, size());
+    else {
+        auto extremes = std::minmax_element(start, avail);
+        return { *extremes.first, *extremes.second };
+    }
+}
 
-    for (size_type i = 0; i < smaller_size; i++)
-        if (at(i) != other[i])
-            return at(i) > other[i];
-    return size() > other.size();
+// Sum of products of elements of both vectors, which must be of the same size
+template <class T, class Allocator, class Growth>
+typename vector<T, Allocator, Growth>::sum_type vector<T, Allocator, Growth>::dot( const vector<T, Allocator, Growth>& other ) const {
+    if (size() != other.size())
+        throw std::invalid_argument{ "vector::dot" };
+    if constexpr (std::is_arithmetic<T>::value)
+        return simd::dot(start, other.start, size());
+    else return std::inner_product(start, avail, other.start, T{});
 }
 
-template <class T>
-bool vector<T>::operator<=(const vector<T>& other) const {
-    // Use the already implemented > operator
-    return *this > other ? false : true;
+// Check if both vectors have the same size and values
+template <class T, class Allocator, class Growth>
+bool vector<T, Allocator, Growth>::operator==(const vector<T, Allocator, Growth>& other) const {
+    return size() == other.size() && equal_elements(start, other.start, size());
 }
 
-template <class T>
-bool vector<T>::operator>=(const vector<T>& other) const {
-    // Use the already implemented < operator
-    return *this < other ? false : true;
-}
\ No newline at end of file
+#ifdef __cpp_lib_three_way_comparison
+// Compare vectors lexicographically, by the first elements which are not equal
+template <class T, class Allocator, class Growth>
+auto vector<T, Allocator, Growth>::operator<=>(const vector<T, Allocator, Growth>& other) const {
+    typedef decltype(synth_three_way(std::declval<const T&>(), std::declval<const T&>())) ordering;
+    size_type common = std::min(size(), other.size());
+    if constexpr (std::is_same<T, unsigned char>::value || std::is_same<T, std::byte>::value) {
+        if (int result = common ? std::memcmp(start, other.start, common) : 0)
+            return ordering(result <=> 0);
+    } else {
+        size_type i = mismatch_index(start, other.start, common);
+        if (i < common)
+            return ordering(synth_three_way(start[i], other.start[i]));
+    }
+    return ordering(size() <=> other.size());
+}
+#else
+template <class T, class Allocator, class Growth>
+bool vector<T, Allocator, Growth>::operator!=(const vector<T, Allocator, Growth>& other) const {
+    return !(*this == other);
+}
+
+// Compare vectors lexicographically, each operator scans them once
+template <class T, class Allocator, class Growth>
+bool vector<T, Allocator, Growth>::operator<(const vector<T, Allocator, Growth>& other) const {
+    return compare_elements(start, size(), other.start, other.size()) < 0;
+}
+
+template <class T, class Allocator, class Growth>
+bool vector<T, Allocator, Growth>::operator>(const vector<T, Allocator, Growth>& other) const {
+    return compare_elements(start, size(), other.start, other.size()) > 0;
+}
+
+template <class T, class Allocator, class Growth>
+bool vector<T, Allocator, Growth>::operator<=(const vector<T, Allocator, Growth>& other) const {
+    return compare_elements(start, size(), other.start, other.size()) <= 0;
+}
+
+template <class T, class Allocator, class Growth>
+bool vector<T, Allocator, Growth>::operator>=(const vector<T, Allocator, Growth>& other) const {
+    return compare_elements(start, size(), other.start, other.size()) >= 0;
+}
+#endif
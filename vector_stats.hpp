@@ -0,0 +1,137 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <ostream>
+
+// Vectors keep statistics of their memory only if VECTOR_STATS is defined
+// before vector.hpp is included. Otherwise VECTOR_STATS_RECORD drops its
+// arguments and vectors hold no counters, so the hooks cost nothing.
+// The counters change the layout of vector, so the macro must be defined
+// the same way in the whole program. Containers which hold them live in an
+// inline namespace named after the setting: translation units which
+// disagree get distinct types, and passing a vector between them fails to
+// link instead of corrupting memory
+#if defined(VECTOR_STATS)
+#define VECTOR_STATS_RECORD(...) __VA_ARGS__
+#define VECTOR_STATS_NAMESPACE stats_on
+#else
+#define VECTOR_STATS_RECORD(...)
+#define VECTOR_STATS_NAMESPACE stats_off
+#endif
+
+// Counters of the blocks vectors allocate and the bytes they move, for
+// each vector (vector::statistics()) and for all of them (stats::global())
+namespace stats {
+
+constexpr bool enabled =
+#if defined(VECTOR_STATS)
+    true;
+#else
+    false;
+#endif
+
+// What a vector, or all vectors of the program, did with memory
+struct counters {
+    size_t allocations = 0;         // blocks taken from allocators
+    size_t deallocations = 0;       // blocks given back
+    size_t reallocations = 0;       // moves of the elements to another block, or resizes of it
+    size_t bytes_relocated = 0;     // bytes of elements those moves copied
+    size_t bytes_held = 0;          // capacity in bytes now
+    size_t peak_bytes_held = 0;     // most capacity in bytes at once
+};
+
+// Counters of all vectors, updated by any thread
+struct shared_counters {
+    std::atomic<size_t> allocations{ 0 }, deallocations{ 0 }, reallocations{ 0 };
+    std::atomic<size_t> bytes_relocated{ 0 }, bytes_held{ 0 }, peak_bytes_held{ 0 };
+};
+
+inline shared_counters& shared() {
+    static shared_counters all;
+    return all;
+}
+
+// Raise *peak* to *value* if it is lower
+inline void raise( std::atomic<size_t>& peak, size_t value ) {
+    size_t seen = peak.load(std::memory_order_relaxed);
+    while (seen < value && !peak.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {}
+}
+
+// Counters of all vectors since the start of the program or the last reset()
+inline counters global() {
+    const shared_counters& all = shared();
+    counters c;
+    c.allocations = all.allocations.load(std::memory_order_relaxed);
+    c.deallocations = all.deallocations.load(std::memory_order_relaxed);
+    c.reallocations = all.reallocations.load(std::memory_order_relaxed);
+    c.bytes_relocated = all.bytes_relocated.load(std::memory_order_relaxed);
+    c.bytes_held = all.bytes_held.load(std::memory_order_relaxed);
+    c.peak_bytes_held = std::max(all.peak_bytes_held.load(std::memory_order_relaxed), c.bytes_held);
+    return c;
+}
+
+// Start counting again; the peak starts from what vectors hold now
+inline void reset() {
+    shared_counters& all = shared();
+    all.allocations = 0;
+    all.deallocations = 0;
+    all.reallocations = 0;
+    all.bytes_relocated = 0;
+    all.peak_bytes_held = all.bytes_held.load();
+}
+
+// A vector took a block of *bytes* from its allocator
+inline void record_allocation( counters& own, size_t bytes ) {
+    shared_counters& all = shared();
+    ++own.allocations;
+    own.peak_bytes_held = std::max(own.peak_bytes_held, bytes);
+    all.allocations.fetch_add(1, std::memory_order_relaxed);
+    raise(all.peak_bytes_held, all.bytes_held.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+}
+
+// A vector gave a block of *bytes* back
+inline void record_deallocation( counters& own, size_t bytes ) {
+    ++own.deallocations;
+    shared().deallocations.fetch_add(1, std::memory_order_relaxed);
+    shared().bytes_held.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+// A vector moved *bytes* of elements to a new block
+inline void record_relocation( counters& own, size_t bytes ) {
+    ++own.reallocations;
+    own.bytes_relocated += bytes;
+    shared().reallocations.fetch_add(1, std::memory_order_relaxed);
+    shared().bytes_relocated.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+// The allocator resized a vector's block from *old_bytes* to *new_bytes* by
+// itself (remap_allocator), so no bytes count as relocated by the vector
+inline void record_resize( counters& own, size_t old_bytes, size_t new_bytes ) {
+    shared_counters& all = shared();
+    ++own.reallocations;
+    own.peak_bytes_held = std::max(own.peak_bytes_held, new_bytes);
+    all.reallocations.fetch_add(1, std::memory_order_relaxed);
+    if (new_bytes >= old_bytes)
+        raise(all.peak_bytes_held, all.bytes_held.fetch_add(new_bytes - old_bytes, std::memory_order_relaxed) + new_bytes - old_bytes);
+    else all.bytes_held.fetch_sub(old_bytes - new_bytes, std::memory_order_relaxed);
+}
+
+// Print counters as one line, i.e. stats::dump(std::cerr, stats::global())
+inline void dump( std::ostream& out, const counters& c, const char* name = "vectors" ) {
+    out << name << ": " << c.allocations << " allocations, " << c.deallocations << " deallocations, "
+        << c.reallocations << " reallocations, " << c.bytes_relocated << " bytes relocated, "
+        << c.bytes_held << " bytes held (peak " << c.peak_bytes_held << ")\n";
+}
+
+// Print the counters of vector *v* and how much of its capacity is unused
+template <class Vector>
+void dump( std::ostream& out, const Vector& v, const char* name = "vector" ) {
+    counters c = v.statistics();
+    out << name << ": " << v.size() << " of " << v.capacity() << " elements used, "
+        << (v.capacity() - v.size()) * sizeof(typename Vector::value_type) << " bytes unused; ";
+    dump(out, c, "history");
+}
+
+}